@@ -49,6 +49,7 @@ int Configuration::s_displayFightRoundDelaySlow = 500;
 bool Configuration::s_displayCommentator = true;
 guint32 Configuration::s_cacheSize = MINIMUM_CACHE_SIZE;
 bool Configuration::s_zipfiles = false;
+guint32 Configuration::s_zip_level = 3;
 int Configuration::s_autosave_policy = 1;
 bool Configuration::s_musicenable = false;
 guint32 Configuration::s_musicvolume = 64;
@@ -136,6 +137,7 @@ bool Configuration::saveConfigurationFile(Glib::ustring filename)
     retval &= helper.saveData("lang", s_lang);
     retval &= helper.saveData("cachesize", s_cacheSize);
     retval &= helper.saveData("zipfiles", s_zipfiles);
+    retval &= helper.saveData("ziplevel", s_zip_level);
     Glib::ustring autosave_policy_str = savingPolicyToString(SavingPolicy(s_autosave_policy));
     retval &= helper.saveData("autosave_policy", autosave_policy_str);
     retval &= helper.saveData("speeddelay", s_displaySpeedDelay);
@@ -240,6 +242,11 @@ bool Configuration::parseConfiguration(XML_Helper* helper)
     if (retval)
         s_zipfiles = zipping;
 
+    //parse how hard they should be zipped
+    retval = helper->getData(temp, "ziplevel");
+    if (retval)
+        s_zip_level = CLAMP(atoi(temp.c_str()), 1, 9);
+
     //parse when and how to save autosave files
     Glib::ustring autosave_policy_str;
     helper->getData(autosave_policy_str, "autosave_policy");
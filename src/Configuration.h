@@ -88,9 +88,12 @@ class Configuration : public sigc::trackable
         //the maximum size of the graphics cache
         static guint32 s_cacheSize;
 
-        //zip and obfuscate save files
+        //compress saved games and maps
         static bool s_zipfiles;
 
+        //how hard to compress them, from 1 (fastest) to 9 (smallest)
+        static guint32 s_zip_level;
+
 	// when to save autosave files
 	// 0 = never, 1 = once a round overwrting, 
 	// 2 = once a round not-overwriting
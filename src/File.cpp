@@ -23,6 +23,7 @@
 #include <config.h>
 
 #include <fstream>
+#include <atomic>
 #include <iostream>
 #include <string.h>
 #include <string>
@@ -43,7 +44,6 @@
 #include "cityset.h"
 #include "file-compat.h"
 #include "ucompose.hpp"
-#include "rnd.h"
 
 #define debug(x) {std::cerr<<__FILE__<<": "<<__LINE__<<": "<<x<<std::endl<<std::flush;}
 //#define debug(x)
@@ -464,12 +464,18 @@ Glib::ustring File::sanify (Glib::ustring s)
   
 Glib::ustring File::get_tmp_file(Glib::ustring ext)
 {
+  // the names are counted instead of being random.  the autosave worker's
+  // thread makes temporary files too, and the random number generator is
+  // neither safe to share between threads nor to use up on file names in a
+  // game with a seed.
+  static std::atomic<guint32> count(0);
   Glib::ustring file = "";
   // fixme, there's a race condition here.
   while (1)
     {
       file = Glib::build_filename (getCacheDir (),
-                                   "lw." + String::ucompose ("%1", Rnd::rand () % 1000000) + ext);
+                                   String::ucompose ("lw.%1.%2%3", getpid (),
+                                                     count++, ext));
       if (File::exists (file) == false)
         break;
     }
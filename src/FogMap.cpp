@@ -16,7 +16,7 @@
 //  02110-1301, USA.
 
 #include <iostream>
-#include <sstream>
+#include <algorithm>
 #include <string>
 
 #include "FogMap.h"
@@ -24,6 +24,8 @@
 
 #include "playerlist.h"
 #include "xmlhelper.h"
+#include "packed-grid.h"
+#include "defs.h"
 #include "GameScenarioOptions.h"
 
 Glib::ustring FogMap::d_tag = "fogmap";
@@ -32,39 +34,64 @@ Glib::ustring FogMap::d_tag = "fogmap";
 #define debug(x)
 
 
+//! Return a mask with bits lo up to but not including hi set.
+static inline guint64 spanMask(int lo, int hi)
+{
+  guint64 upper = hi >= 64 ? ~G_GUINT64_CONSTANT(0) :
+    (G_GUINT64_CONSTANT(1) << hi) - 1;
+  return upper & ~((G_GUINT64_CONSTANT(1) << lo) - 1);
+}
+
 FogMap::FogMap(int width, int height)
+ : d_dirty(0, 0, 0, 0)
 {
     debug("FogMap()");
     d_width = width;
     d_height = height;
+    d_stride = (d_width + 63) / 64;
 
-    d_fogmap = new FogType[d_width*d_height];
+    d_fogmap.assign(d_stride * d_height, 0);
     shademap = new ShadeType[d_width*d_height];
 
     fill(OPEN);
 }
 
 FogMap::FogMap(XML_Helper* helper)
+ : d_dirty(0, 0, 0, 0)
 {
     Glib::ustring t;
     
     helper->getData(d_width, "width");
     helper->getData(d_height, "height");
     helper->getData(t, "map");
-    std::string types = t.raw();
-    types.erase (std::remove(types.begin(), types.end(), '\n'), types.end());
-    types.erase (std::remove(types.begin(), types.end(), '\r'), types.end());
 
     //create the map
-    d_fogmap = new FogType[d_width*d_height];
+    d_stride = (d_width + 63) / 64;
+    d_fogmap.assign(d_stride * d_height, 0);
+
+    std::vector<guint32> types;
+    guint32 count = d_width * d_height;
+    if (PackedGrid::isPacked(t))
+      {
+        if (PackedGrid::unpack(t, count, types) == false)
+          std::cerr << _("Error!  The fog of a player's map is damaged.") << std::endl;
+      }
+    else
+      {
+        // the old form: a digit for every tile, and a line for every row.
+        types.reserve(count);
+        for (const char *letter = t.c_str(); *letter; letter++)
+          if (*letter != '\n' && *letter != '\r' && types.size() < count)
+            types.push_back(*letter - '0');
+        types.resize(count, OPEN);
+      }
 
     for (int y = 0; y < d_height; y++)
     {
         for (int x = 0; x < d_width; x++)
         {
-            //due to the circumstances, types is a long stream of
-            //numbers, so read it character for character (no \n's or so)
-            d_fogmap[y*d_width + x] = FogType(types[y*d_width + x] - '0');
+            if (FogType(types[y*d_width + x]) == CLOSED)
+              d_fogmap[y*d_stride + x / 64] |= G_GUINT64_CONSTANT(1) << (x % 64);
         }
     }
     shademap = new ShadeType[d_width*d_height];
@@ -72,18 +99,9 @@ FogMap::FogMap(XML_Helper* helper)
 }
 
 FogMap::FogMap(const FogMap& fogmap)
-    :d_width(fogmap.d_width), d_height(fogmap.d_height)
+    :d_width(fogmap.d_width), d_height(fogmap.d_height),
+    d_stride(fogmap.d_stride), d_fogmap(fogmap.d_fogmap), d_dirty(0, 0, 0, 0)
 {
-    //create the map
-    d_fogmap = new FogType[d_width*d_height];
-
-    for (int y = 0; y < d_height; y++)
-    {
-        for (int x = 0; x < d_width; x++)
-        {
-            d_fogmap[y*d_width + x] = fogmap.d_fogmap[y*d_width + x];
-        }
-    }
     shademap = new ShadeType[d_width*d_height];
     for (int y = 0; y < d_height; y++)
     {
@@ -96,14 +114,13 @@ FogMap::FogMap(const FogMap& fogmap)
 
 FogMap::~FogMap()
 {
-    delete[] d_fogmap;
     delete[] shademap;
 }
 
 bool FogMap::fill(FogType type)
 {
-    for (int i = 0; i < d_width*d_height; i++)
-        d_fogmap[i] = type;
+    for (int y = 0; y < d_height; y++)
+        setSpan(y, 0, d_width, type);
 
     calculateShadeMap();
     return true;
@@ -117,18 +134,13 @@ bool FogMap::save(XML_Helper* helper) const
     retval &= helper->saveData("width", d_width);
     retval &= helper->saveData("height", d_height);
 
-    std::stringstream types;
-    types << std::endl;
+    std::vector<guint32> types;
+    types.reserve(d_width * d_height);
     for (int y = 0; y < d_height; y++)
-    {
         for (int x = 0; x < d_width; x++)
-        {
-            types << static_cast<int>(d_fogmap[y*d_width + x]);
-        }
-        types << std::endl;
-    }
+            types.push_back(getFogTile(Vector<int>(x, y)));
 
-    retval &= helper->saveData("map", types.str());
+    retval &= helper->saveData("map", PackedGrid::pack(types));
     retval &= helper->closeTag();
 
     return retval;
@@ -136,7 +148,7 @@ bool FogMap::save(XML_Helper* helper) const
 
 FogMap::FogType FogMap::getFogTile(Vector<int> pos) const
 {
-    return d_fogmap[pos.y * d_width + pos.x];
+    return isClosed(pos.x, pos.y) ? CLOSED : OPEN;
 }
 
 FogMap::ShadeType FogMap::getShadeTile(Vector<int> pos) const
@@ -144,43 +156,58 @@ FogMap::ShadeType FogMap::getShadeTile(Vector<int> pos) const
     return shademap[pos.y * d_width + pos.x];
 }
 
+void FogMap::setSpan(int y, int x1, int x2, FogType type)
+{
+    if (x1 >= x2)
+      return;
+    guint64 *row = &d_fogmap[y * d_stride];
+    bool changed = false;
+    for (int k = x1 / 64; k <= (x2 - 1) / 64; k++)
+      {
+        guint64 mask = spanMask(std::max(x1 - k * 64, 0),
+                                std::min(x2 - k * 64, 64));
+        guint64 old = row[k];
+        if (type == CLOSED)
+          row[k] |= mask;
+        else
+          row[k] &= ~mask;
+        if (row[k] != old)
+          changed = true;
+      }
+    if (changed)
+      {
+        markDirty(x1, y);
+        markDirty(x2 - 1, y);
+      }
+}
+
 void FogMap::alterFogRadius(Vector<int> pt, int radius, FogType new_type)
 {
     if (GameScenarioOptions::s_hidden_map == false)
       return;
     // this doesn't draw a circle, it draws a square
     // it isn't a bug, except for being badly named
-    int x = pt.x - radius;
-    int y = pt.y - radius;
-    int size = 2 * radius + 1;
-    for (int i = 0; i < size; i++)
-    {
-        for (int j = 0; j < size; j++)
-        {
-            if ((x+i) < 0 || (y+j) < 0 || (x+i) >= d_width || (y+j) >= d_height)
-                continue;
-            d_fogmap[(y+j)*d_width + (x+i)] = new_type;
-        }
-    }
-    calculateShadeMap();
+    int x1 = std::max(pt.x - radius, 0);
+    int x2 = std::min(pt.x + radius + 1, d_width);
+    int y1 = std::max(pt.y - radius, 0);
+    int y2 = std::min(pt.y + radius + 1, d_height);
+    for (int y = y1; y < y2; y++)
+      setSpan(y, x1, x2, new_type);
+    updateShadeMap();
 }
 
 void FogMap::alterFogRectangle(Vector<int> pt, int height, int width, FogType new_type)
 {
     if (GameScenarioOptions::s_hidden_map == false)
       return;
-    int x = pt.x;
-    int y = pt.y;
-    for (int i = 0; i < height; i++)
-    {
-        for (int j = 0; j < width; j++)
-        {
-            if ((x+i) < 0 || (y+j) < 0 || (x+i) >= d_width || (y+j) >= d_height)
-                continue;
-            d_fogmap[(y+j)*d_width + (x+i)] = new_type;
-        }
-    }
-    calculateShadeMap();
+    // the height runs along the x axis, and the width along the y axis.
+    int x1 = std::max(pt.x, 0);
+    int x2 = std::min(pt.x + height, d_width);
+    int y1 = std::max(pt.y, 0);
+    int y2 = std::min(pt.y + width, d_height);
+    for (int y = y1; y < y2; y++)
+      setSpan(y, x1, x2, new_type);
+    updateShadeMap();
 }
 
 bool FogMap::isCompletelyObscuredFogTile(Vector<int> pos) const
@@ -197,16 +224,16 @@ bool FogMap::isLoneFogTile(Vector<int> pos)
   bool west_open = false;
   bool east_open = false;
   //are east-west adjacent squares open?
-  if (pos.x + 1 >= d_width || d_fogmap[pos.y*d_width + pos.x + 1] == OPEN)
+  if (pos.x + 1 >= d_width || !isClosed(pos.x + 1, pos.y))
     west_open = true;
-  if (pos.x - 1 < 0 || d_fogmap[pos.y*d_width + pos.x - 1] == OPEN)
+  if (pos.x - 1 < 0 || !isClosed(pos.x - 1, pos.y))
     east_open = true;
   bool north_open = false;
   bool south_open = false;
   //are north-south adjacent squares open?
-  if (pos.y + 1 >= d_height || d_fogmap[(pos.y+1)*d_width + pos.x] == OPEN)
+  if (pos.y + 1 >= d_height || !isClosed(pos.x, pos.y + 1))
     south_open = true;
-  if (pos.y - 1 < 0 || d_fogmap[(pos.y-1)*d_width + pos.x] == OPEN)
+  if (pos.y - 1 < 0 || !isClosed(pos.x, pos.y - 1))
     north_open = true;
   if (east_open && west_open)
     return true;
@@ -217,22 +244,46 @@ bool FogMap::isLoneFogTile(Vector<int> pos)
 
 void FogMap::smooth()
 {
+    // the bits past the edge of the map are always open, so a row of
+    // zeroes stands in for the rows above and below the map.
+    std::vector<guint64> edge(d_stride, 0);
+    std::vector<guint64> lone(d_stride, 0);
+    std::vector<guint64> orig(d_stride, 0);
     for (int y = 0; y < d_height; y++)
     {
-        for (int x = 0; x < d_width; x++)
-        {
-            if (d_fogmap[y*d_width + x] == CLOSED)
+        guint64 *row = &d_fogmap[y * d_stride];
+        const guint64 *above = y > 0 ? row - d_stride : &edge[0];
+        const guint64 *below = y + 1 < d_height ? row + d_stride : &edge[0];
+        std::copy(row, row + d_stride, orig.begin());
+        // the sweep goes tile by tile, so a tile sees its western neighbour
+        // after it was smoothed, and its eastern one before.  a tile that
+        // gets opened can only make the tile to its east lone, and only
+        // when it was opened by the tiles above and below it, so a second
+        // pass over the row catches all of those.
+        for (int pass = 0; pass < 2; pass++)
+          {
+            for (int k = 0; k < d_stride; k++)
               {
-		Vector<int> pos;
-		pos.x = x;
-		pos.y = y;
-                if (isLoneFogTile (pos))
-                  d_fogmap[y*d_width + x] = OPEN;
+                guint64 closed = orig[k];
+                guint64 left = (row[k] << 1) | (k > 0 ? row[k - 1] >> 63 : 0);
+                guint64 right =
+                  (closed >> 1) | (k + 1 < d_stride ? orig[k + 1] << 63 : 0);
+                lone[k] =
+                  closed & ((~left & ~right) | (~above[k] & ~below[k]));
               }
-        }
+            for (int k = 0; k < d_stride; k++)
+              row[k] = orig[k] & ~lone[k];
+          }
+        for (int k = 0; k < d_stride; k++)
+          {
+            if (lone[k] == 0)
+              continue;
+            markDirty(k * 64, y);
+            markDirty(std::min(k * 64 + 63, d_width - 1), y);
+          }
     }
 
-    calculateShadeMap();
+    updateShadeMap();
 }
 
 bool FogMap::isFogged(Vector <int> pos)
@@ -461,13 +512,49 @@ FogMap::ShadeType FogMap::calculateShade(Vector<int> tile)
 
 void FogMap::calculateShadeMap()
 {
-  for (int i = 0; i < d_width; i++)
-    for (int j = 0; j < d_height; j++)
-      shademap[j * d_width + i] = calculateShade(Vector<int>(i,j));
-
-  for (int i = 0; i < d_width; i++)
-    for (int j = 0; j < d_height; j++)
-      if (isFogged(Vector<int>(i,j)) == false)
-	  shademap[j * d_width + i] = NONE;
+  d_dirty = LwRectangle(0, 0, 0, 0);
+  calculateShadeMap(LwRectangle(0, 0, d_width, d_height));
+}
+
+void FogMap::calculateShadeMap(LwRectangle r)
+{
+  for (int i = r.x; i < r.x + r.w; i++)
+    for (int j = r.y; j < r.y + r.h; j++)
+      {
+        Vector<int> pos(i, j);
+        if (isFogged(pos) == false)
+          shademap[j * d_width + i] = NONE;
+        else
+          shademap[j * d_width + i] = calculateShade(pos);
+      }
+  shades_changed.emit(r);
+}
+
+void FogMap::markDirty(int x, int y)
+{
+  if (d_dirty.w == 0 || d_dirty.h == 0)
+    {
+      d_dirty = LwRectangle(x, y, 1, 1);
+      return;
+    }
+  int x2 = std::max(d_dirty.x + d_dirty.w, x + 1);
+  int y2 = std::max(d_dirty.y + d_dirty.h, y + 1);
+  d_dirty.x = std::min(d_dirty.x, x);
+  d_dirty.y = std::min(d_dirty.y, y);
+  d_dirty.w = x2 - d_dirty.x;
+  d_dirty.h = y2 - d_dirty.y;
+}
+
+void FogMap::updateShadeMap()
+{
+  if (d_dirty.w == 0 || d_dirty.h == 0)
+    return;
+  //a tile's shade depends on its neighbours, so include a border of 1.
+  int x1 = std::max(d_dirty.x - 1, 0);
+  int y1 = std::max(d_dirty.y - 1, 0);
+  int x2 = std::min(d_dirty.x + d_dirty.w + 1, d_width);
+  int y2 = std::min(d_dirty.y + d_dirty.h + 1, d_height);
+  d_dirty = LwRectangle(0, 0, 0, 0);
+  calculateShadeMap(LwRectangle(x1, y1, x2 - x1, y2 - y1));
 }
 // End of file
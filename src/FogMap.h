@@ -20,8 +20,11 @@
 #define FOGMAP_H
 
 #include <list>
+#include <vector>
 #include <glibmm.h>
+#include <sigc++/signal.h>
 #include "vector.h"
+#include "rectangle.h"
 
 class XML_Helper;
 class SightMap;
@@ -168,9 +171,34 @@ class FogMap
 
 	ShadeType calculateShade(Vector<int> tile);
 
+	//! Emitted when the shades of the tiles in a region have changed.
+	sigc::signal<void, LwRectangle> shades_changed;
+
     private:
 
+	//! Is the given tile closed to view?
+	bool isClosed(int x, int y) const
+	  {return (d_fogmap[y * d_stride + x / 64] >> (x % 64)) & 1;}
+
+	//! Set the fog on row y from x1 up to but not including x2.
+	void setSpan(int y, int x1, int x2, FogType type);
+
+	//! Recalculate the shade of every tile on the map.
 	void calculateShadeMap();
+
+	//! Recalculate the shade of the tiles in the given region.
+	void calculateShadeMap(LwRectangle r);
+
+	//! Remember that the fog on the given tile has changed.
+	void markDirty(int x, int y);
+
+	//! Recalculate the shades around the tiles that have changed.
+	/**
+	 * A tile's shade depends on the fog of its eight neighbours, so the
+	 * dirty region is grown by one tile on every side before the shades
+	 * are recalculated.
+	 */
+	void updateShadeMap();
         // Data
 	//! The width of the fog map.
         int d_width;
@@ -178,10 +206,20 @@ class FogMap
 	//! The height of the fog map.
         int d_height;
 
-	//! An array of tiles that describe how a tile is fogged.
-        FogType * d_fogmap;
+	//! The number of 64-bit words in each row of the fog map.
+        int d_stride;
+
+	//! One bit per tile that is set when the tile is closed to view.
+	/**
+	 * Each row starts on a fresh word, and the bits past the right
+	 * edge of the map are always zero.
+	 */
+        std::vector<guint64> d_fogmap;
 	ShadeType *shademap;
 
+	//! The region of the fog map that changed since the last shade update.
+	LwRectangle d_dirty;
+
 	//! A list of tiles that are completely obscured.
 	std::list<Vector<int> > completely_obscured;
 };
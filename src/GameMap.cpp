@@ -24,6 +24,7 @@
 #include <sstream>
 #include <iostream>
 #include <string>
+#include <map>
 #include <iomanip>
 #include <assert.h>
 #include <sigc++/functors/mem_fun.h>
@@ -51,6 +52,7 @@
 #include "templelist.h"
 #include "signpostlist.h"
 #include "xmlhelper.h"
+#include "packed-grid.h"
 #include "MapGenerator.h"
 #include "tilesetlist.h"
 #include "shieldsetlist.h"
@@ -94,12 +96,12 @@ GameMap* GameMap::getInstance(Glib::ustring TilesetName,
     return s_instance;
 }
 
-GameMap* GameMap::getInstance(XML_Helper* helper)
+GameMap* GameMap::getInstance(XML_Helper* helper, bool &broken)
 {
     if (s_instance)
         deleteInstance();
 
-    s_instance = new GameMap(helper);
+    s_instance = new GameMap(helper, broken);
 
     return s_instance;
 }
@@ -197,7 +199,7 @@ int GameMap::determineCharsPerStyle(Glib::ustring styles)
   return styles.length() / (s_width * s_height);
 }
 
-GameMap::GameMap(XML_Helper* helper)
+GameMap::GameMap(XML_Helper* helper, bool &broken)
 {
     s_tileset = 0;
     s_cityset = 0;
@@ -230,24 +232,68 @@ GameMap::GameMap(XML_Helper* helper)
     //create the map
     d_map = new Maptile[s_width*s_height];
 
-    int row = 0, col = 0;
-    for (const char *letter = types.c_str(); *letter; letter++)
+    guint32 count = s_width * s_height;
+    std::vector<guint32> values;
+    if (PackedGrid::isPacked(types))
       {
-        if (*letter == '\n' || *letter == '\r')
-          continue;
-        d_map[row*s_width + col].setPos(Vector<int>(col, row));
-        guint32 type = *letter - '0';
-        d_map[row*s_width + col].setIndex(GameMap::getTileset()->lookupIndexByType (type == 0 ? Tile::Type (type) : Tile::Type (pow(2,type-1))));
-        col++;
-        if (col >= s_width)
+        if (PackedGrid::unpack(types, count, values) == false)
           {
-            col = 0;
-            row++;
+            std::cerr << _("Error!  The terrain of the map is damaged.") << std::endl;
+            broken = true;
           }
       }
+    else
+      {
+        // the old form: a digit for every tile, and a line for every row.
+        values.reserve(count);
+        for (const char *letter = types.c_str(); *letter; letter++)
+          if (*letter != '\n' && *letter != '\r' && values.size() < count)
+            values.push_back(*letter - '0');
+        values.resize(count, 0);
+      }
 
-    int chars_per_style = determineCharsPerStyle(styles);
-    processStyles(styles, chars_per_style);
+    // there are only a few kinds of terrain, so look each one up once.
+    std::map<guint32, int> indices;
+    for (int row = 0; row < s_height; row++)
+      for (int col = 0; col < s_width; col++)
+        {
+          guint32 type = values[row*s_width + col];
+          std::map<guint32, int>::iterator it = indices.find(type);
+          if (it == indices.end())
+            it = indices.insert(std::make_pair(type, GameMap::getTileset()->lookupIndexByType (type == 0 ? Tile::Type (type) : Tile::Type (pow(2,type-1))))).first;
+          d_map[row*s_width + col].setPos(Vector<int>(col, row));
+          d_map[row*s_width + col].setIndex(it->second);
+        }
+
+    if (PackedGrid::isPacked(styles))
+      {
+        if (PackedGrid::unpack(styles, count, values) == false)
+          {
+            std::cerr << _("Error!  The tile styles of the map are damaged.") << std::endl;
+            broken = true;
+          }
+        for (guint32 i = 0; i < count; i++)
+          d_map[i].setTileStyleId(values[i]);
+      }
+    else
+      {
+        int chars_per_style = determineCharsPerStyle(styles);
+        processStyles(styles, chars_per_style);
+      }
+
+    // every tile has to have a style that the tileset knows about.  the
+    // styles come in long runs, so only look up the ones that change.
+    for (guint32 i = 0; i < count && !broken; i++)
+      {
+        guint32 id = d_map[i].getTileStyleId();
+        if (i > 0 && id == d_map[i-1].getTileStyleId())
+          continue;
+        if (tileset->getTileStyle(id) == NULL)
+          {
+            std::cerr << String::ucompose(_("Error!  The map has a tile style id of %1, but the tileset doesn't have it."), id) << std::endl;
+            broken = true;
+          }
+      }
 
     //add some callbacks for item loading
     helper->registerTag(MapBackpack::d_mapbackpack_tag, sigc::mem_fun(this, &GameMap::loadItems));
@@ -301,41 +347,21 @@ bool GameMap::fill(guint32 type)
 
 bool GameMap::save(XML_Helper* helper) const
 {
-    Tileset *tileset = GameMap::getTileset();
     bool retval = true;
 
-    std::stringstream types;
-
-    types <<std::endl;
-    for (int i = 0; i < s_height; i++)
-    {
-        for (int j = 0; j < s_width; j++)
-          {
-            guint32 tile_type = getTile(j, i)->getType();
-            if (tile_type != 0)
-              tile_type = log2(tile_type)+1;
-            types << (guint32) tile_type;
-          }
-        types <<std::endl;
-    }
-
-    std::stringstream styles;
-    styles <<std::endl;
-	    
-    int largest_style_id = tileset->getLargestTileStyleId();
-    guint32 num_digits = TileStyle::calculateHexDigits(largest_style_id);
+    std::vector<guint32> types;
+    std::vector<guint32> styles;
+    types.reserve(s_width * s_height);
+    styles.reserve(s_width * s_height);
     for (int i = 0; i < s_height; i++)
-    {
-        for (int j = 0; j < s_width; j++)
-	  {
-	    Glib::ustring hexstr;
-	    guint32 id = getTile(j, i)->getTileStyleId();
-            hexstr = TileStyle::idToString(id, num_digits);
-	    styles << hexstr;
-	  }
-        styles <<std::endl;
-    }
-
+      for (int j = 0; j < s_width; j++)
+        {
+          guint32 tile_type = getTile(j, i)->getType();
+          if (tile_type != 0)
+            tile_type = log2(tile_type)+1;
+          types.push_back(tile_type);
+          styles.push_back(getTile(j, i)->getTileStyleId());
+        }
 
     retval &= helper->openTag(GameMap::d_tag);
     retval &= helper->saveData("width", s_width);
@@ -343,8 +369,8 @@ bool GameMap::save(XML_Helper* helper) const
     retval &= helper->saveData("tileset", d_tileset);
     retval &= helper->saveData("shieldset", d_shieldset);
     retval &= helper->saveData("cityset", d_cityset);
-    retval &= helper->saveData("types", types.str());
-    retval &= helper->saveData("styles", styles.str());
+    retval &= helper->saveData("types", PackedGrid::pack(types));
+    retval &= helper->saveData("styles", PackedGrid::pack(styles));
 
     // last, save all items lying around somewhere
     for (int i = 0; i < s_width; i++)
@@ -1418,6 +1444,7 @@ void GameMap::switchArmysets(Player *p, Armyset *armyset)
         }
       for (Stack::iterator k = s->begin(); k != s->end(); ++k)
         Armyset::switchArmyset(*k,armyset);
+      s->invalidateCache();
     }
 
   //finally, change the player's armyset.
@@ -1471,6 +1498,7 @@ void GameMap::switchArmysets(Armyset *armyset)
             }
           for (Stack::iterator k = s->begin(); k != s->end(); ++k)
             Armyset::switchArmyset(*k,armyset);
+          s->invalidateCache();
 	}
 
       //finally, change the player's armyset.
@@ -2208,6 +2236,7 @@ void GameMap::updateShips(Vector<int> pos)
 	    (*sit)->setInShip(false);
 
 	}
+      (*it)->invalidateCache();
     }
 }
 
@@ -2529,46 +2558,54 @@ bool GameMap::eraseTile(Vector<int> tile)
   return erased;
 }
 
+// the images of the sets are loaded the first time the map uses them.
+
 Tileset* GameMap::getTileset()
 {
+  bool broken = false;
   if (s_tileset == 0)
-    s_tileset = Tilesetlist::getInstance()->get(GameMap::getInstance()->getTilesetBaseName());
+    s_tileset = Tilesetlist::getInstance()->ensureImages(GameMap::getInstance()->getTilesetBaseName(), broken);
     
   return s_tileset;
 }
 
 Cityset* GameMap::getCityset()
 {
+  bool broken = false;
   if (s_cityset == 0)
-    s_cityset = Citysetlist::getInstance()->get(GameMap::getInstance()->getCitysetBaseName());
+    s_cityset = Citysetlist::getInstance()->ensureImages(GameMap::getInstance()->getCitysetBaseName(), broken);
     
   return s_cityset;
 }
 
 Shieldset* GameMap::getShieldset()
 {
+  bool broken = false;
   if (s_shieldset == 0)
-    s_shieldset = Shieldsetlist::getInstance()->get(GameMap::getInstance()->getShieldsetId());
+    s_shieldset = Shieldsetlist::getInstance()->ensureImages(GameMap::getInstance()->getShieldsetId(), broken);
     
   return s_shieldset;
 }
 
 void GameMap::setTileset(Glib::ustring tileset)
 {
+  bool broken = false;
   d_tileset = tileset;
-  s_tileset = Tilesetlist::getInstance()->get(tileset);
+  s_tileset = Tilesetlist::getInstance()->ensureImages(tileset, broken);
 }
 
 void GameMap::setCityset(Glib::ustring cityset)
 {
+  bool broken = false;
   d_cityset = cityset;
-  s_cityset = Citysetlist::getInstance()->get(cityset);
+  s_cityset = Citysetlist::getInstance()->ensureImages(cityset, broken);
 }
 
 void GameMap::setShieldset(Glib::ustring shieldset)
 {
+  bool broken = false;
   d_shieldset = shieldset;
-  s_shieldset = Shieldsetlist::getInstance()->get(shieldset);
+  s_shieldset = Shieldsetlist::getInstance()->ensureImages(shieldset, broken);
 }
 
 bool GameMap::can_search(Stack *stack)
@@ -95,10 +95,11 @@ class GameMap: public sigc::trackable
         /** Creates a new singleton instance from a savegame file
           * 
           * @param helper           see XML_Helper for an explanation
+          * @param broken           set to true if the map couldn't be read
           *
           * \note This function deletes an existing instance!
           */
-        static GameMap* getInstance(XML_Helper* helper);
+        static GameMap* getInstance(XML_Helper* helper, bool &broken);
 
         //! Explicitly deletes the singleton instance
         static void deleteInstance();
@@ -1452,7 +1453,7 @@ class GameMap: public sigc::trackable
         GameMap (const GameMap &m);
 
         //! Load the map using the given XML_Helper
-        GameMap(XML_Helper* helper);
+        GameMap(XML_Helper* helper, bool &broken);
 
     private:
         //! Callback for item loading used during loading.
@@ -30,6 +30,7 @@
 
 #include "ucompose.hpp"
 #include "GameScenario.h"
+#include "autosave-worker.h"
 #include "MapGenerator.h"
 #include "playerlist.h"
 #include "FogMap.h"
@@ -73,6 +74,7 @@
 #include "Item.h"
 #include "rnd.h"
 #include "game-actionlist.h"
+#include "round-journal.h"
 #include "ScenarioMedia.h"
 #include "herotemplates.h"
 #include "heroproto.h"
@@ -111,6 +113,8 @@ GameScenario::GameScenario(Glib::ustring savegame, bool& broken)
     d_playmode(GameScenario::HOTSEAT), inhibit_autosave_removal(false),
     loaded_game_filename(""), d_unique (true)
 {
+  // the file might be an autosave that is still being written.
+  AutosaveWorker::getInstance()->wait();
   Tar_Helper t(savegame, std::ios::in, broken);
   load_tick.emit ();
   if (broken == false)
@@ -129,7 +133,15 @@ GameScenario::GameScenario(Glib::ustring savegame, bool& broken)
       ext.push_back(SAVE_EXT);
       Glib::ustring filename = t.getFirstFile(ext, broken);
       XML_Helper helper(filename, std::ios::in);
+      RoundJournal::deleteInstance();
       broken = loadWithHelper(helper);
+      if (!broken && RoundJournal::getInstance()->isEmpty() == false)
+        {
+          // the saved game can't be played without what's in its journal.
+          Glib::ustring journal = RoundJournal::getFilename(savegame);
+          if (RoundJournal::getInstance()->load(journal) == false)
+            broken = true;
+        }
       load_tick.emit ();
       ScenarioMedia::getInstance()->instantiateImages(t, broken);
       load_tick.emit ();
@@ -167,7 +179,7 @@ bool GameScenario::loadArmysets(Tar_Helper *t)
     {
       guint32 id = Armysetlist::getInstance()->import(t, *it, broken);
       if (!broken)
-        Armysetlist::getInstance()->get(id)->instantiateImages(true, broken);
+        Armysetlist::getInstance()->ensureImages(id, broken);
     }
   return !broken;
 }
@@ -180,7 +192,7 @@ bool GameScenario::loadTilesets(Tar_Helper *t)
     {
       guint32 id = Tilesetlist::getInstance()->import(t, it, broken);
       if (!broken)
-        Tilesetlist::getInstance()->get(id)->instantiateImages(true, broken);
+        Tilesetlist::getInstance()->ensureImages(id, broken);
     }
   return !broken;
 }
@@ -193,7 +205,7 @@ bool GameScenario::loadCitysets(Tar_Helper *t)
     {
       guint32 id = Citysetlist::getInstance()->import(t, it, broken);
       if (!broken)
-        Citysetlist::getInstance()->get(id)->instantiateImages(true, broken);
+        Citysetlist::getInstance()->ensureImages(id, broken);
     }
   return !broken;
 }
@@ -207,7 +219,7 @@ bool GameScenario::loadShieldsets(Tar_Helper *t)
     {
       guint32 id = Shieldsetlist::getInstance()->import(t, it, broken);
       if (!broken)
-        Shieldsetlist::getInstance()->get(id)->instantiateImages(true, broken);
+        Shieldsetlist::getInstance()->ensureImages(id, broken);
     }
   return !broken;
 }
@@ -688,6 +700,7 @@ bool GameScenario::loadWithHelper(XML_Helper& helper)
   helper.registerTag(Portlist::d_tag, sigc::mem_fun(this, &GameScenario::load));
   helper.registerTag(VectoredUnitlist::d_tag, sigc::mem_fun(this, &GameScenario::load));
   helper.registerTag(GameActionlist::d_tag, sigc::mem_fun(this, &GameScenario::load));
+  helper.registerTag(RoundJournal::d_tag, sigc::mem_fun(this, &GameScenario::load));
   helper.registerTag(ScenarioMedia::d_tag, sigc::mem_fun(this, &GameScenario::load));
   helper.registerTag(HeroTemplates::d_tag, sigc::mem_fun(this, &GameScenario::load));
 
@@ -706,6 +719,8 @@ bool GameScenario::loadWithHelper(XML_Helper& helper)
 
 GameScenario::~GameScenario()
 {
+  // the autosave might still be reading our files.
+  AutosaveWorker::getInstance()->wait();
   if (d_unique)
     cleanup();
   if (Configuration::s_autosave_policy == 1 && 
@@ -713,6 +728,7 @@ GameScenario::~GameScenario()
     {
       Glib::ustring filename = File::getSaveFile("autosave" + SAVE_EXT);
       File::erase(filename);
+      File::erase(RoundJournal::getFilename(filename));
     }
   clean_tmp_dir();
 } 
@@ -736,27 +752,15 @@ bool GameScenario::dump(Glib::ustring filename, Glib::ustring extension) const
   Glib::ustring tmpfile = File::get_tmp_file();
   XML_Helper helper(tmpfile, std::ios::out);
   retval &= saveWithHelper(helper);
-  helper.close();
+  retval &= helper.close();
 
   if (retval == false)
     return false;
 
-  bool broken = false;
-  Tar_Helper t(goodfilename, std::ios::out, broken);
-  if (broken == true)
-    return false;
-
-  t.saveFile(tmpfile, File::get_basename(goodfilename, true));
-  File::erase(tmpfile);
-
-  Cityset *cs = GameMap::getCityset();
-  t.saveFile(cs->getConfigurationFile());
-
-  Shieldset *ss = GameMap::getShieldset();
-  t.saveFile(ss->getConfigurationFile());
-
-  Tileset *ts = GameMap::getTileset();
-  t.saveFile(ts->getConfigurationFile());
+  std::vector<Glib::ustring> files;
+  files.push_back(GameMap::getCityset()->getConfigurationFile());
+  files.push_back(GameMap::getShieldset()->getConfigurationFile());
+  files.push_back(GameMap::getTileset()->getConfigurationFile());
  
   std::list<guint32> armysets;
   for (auto it: *Playerlist::getInstance())
@@ -769,28 +773,35 @@ bool GameScenario::dump(Glib::ustring filename, Glib::ustring extension) const
   for (auto it: armysets)
     {
       Armyset *as = Armysetlist::getInstance()->get(it);
-      t.saveFile(as->getConfigurationFile());
+      files.push_back(as->getConfigurationFile());
     }
 
-  return true;
+  // there are no images to bring along from a tar file we were made from.
+  Glib::ustring tmptar = File::get_tmp_file() + ".tar";
+  int compression =
+    Configuration::s_zipfiles ? Configuration::s_zip_level : 0;
+  return saveTarFrom("", tmpfile, tmptar, goodfilename, files, compression);
 }
 
-bool GameScenario::saveGame(Glib::ustring filename, Glib::ustring extension) const
+bool GameScenario::saveGame(Glib::ustring filename, Glib::ustring extension, bool binary) const
 {
   bool retval = true;
   Glib::ustring goodfilename = File::add_ext_if_necessary(filename, extension);
   debug("saving game to " + goodfilename);
 
   Glib::ustring tmpfile = File::get_tmp_file();
-  XML_Helper helper(tmpfile, std::ios::out);
+  XML_Helper helper(tmpfile, binary ? std::ios::out | std::ios::binary :
+                    std::ios::out);
   retval &= saveWithHelper(helper);
-  helper.close();
+  retval &= helper.close();
 
   if (retval == false)
     return false;
 
   Glib::ustring tmptar = File::get_tmp_file() + ".tar";
-  retval = saveTar(tmpfile, tmptar, goodfilename, getSetFiles ());
+  int compression =
+    Configuration::s_zipfiles ? Configuration::s_zip_level : 0;
+  retval = saveTar(tmpfile, tmptar, goodfilename, getSetFiles (), compression);
 
   return retval;
 }
@@ -807,7 +818,7 @@ std::vector<Glib::ustring> GameScenario::getSetFiles () const
   return sets;
 }
 
-bool GameScenario::saveWithHelper(XML_Helper &helper) const
+bool GameScenario::saveWithHelper(XML_Helper &helper, bool journaled) const
 {
   bool retval = true;
 
@@ -819,7 +830,7 @@ bool GameScenario::saveWithHelper(XML_Helper &helper) const
   //now save the single object's data
   retval &= fl_counter->save(&helper);
   retval &= Itemlist::getInstance()->save(&helper);
-  retval &= Playerlist::getInstance()->save(&helper);
+  retval &= Playerlist::getInstance()->save(&helper, journaled);
   retval &= GameMap::getInstance()->save(&helper);
   retval &= Citylist::getInstance()->save(&helper);
   retval &= Templelist::getInstance()->save(&helper);
@@ -832,7 +843,14 @@ bool GameScenario::saveWithHelper(XML_Helper &helper) const
   retval &= Bridgelist::getInstance()->save(&helper);
   retval &= QuestsManager::getInstance()->save(&helper);
   retval &= VectoredUnitlist::getInstance()->save(&helper);
-  retval &= GameActionlist::getInstance()->save(&helper);
+  if (journaled)
+    {
+      retval &= RoundJournal::getInstance()->save(&helper);
+      retval &= GameActionlist::getInstance()->save
+        (&helper, RoundJournal::getInstance()->getTurns());
+    }
+  else
+    retval &= GameActionlist::getInstance()->save(&helper);
   if (HeroTemplates::getInstance()->isDefault () == false)
     retval &= HeroTemplates::getInstance()->save(&helper);
 
@@ -958,8 +976,9 @@ bool GameScenario::load(Glib::ustring tag, XML_Helper* helper)
   if (tag == GameMap::d_tag)
     {
       debug("loading map")
-	GameMap::getInstance(helper);
-      return true;
+      bool broken = false;
+      GameMap::getInstance(helper, broken);
+      return !broken;
     }
 
   if (tag == Citylist::d_tag)
@@ -1046,6 +1065,12 @@ bool GameScenario::load(Glib::ustring tag, XML_Helper* helper)
       return true;
     }
 
+  if (tag == RoundJournal::d_tag)
+    {
+      RoundJournal::getInstance(helper);
+      return true;
+    }
+
   if (tag == ScenarioMedia::d_tag)
     {
       ScenarioMedia::getInstance(helper);
@@ -1078,20 +1103,36 @@ bool GameScenario::autoSave()
   // We can be somewhat assured the rename works, because we are renaming
   // from ~/.cache/lordsawar/<file> to ~/.local/share/lordsawar/<file>
   //
-  Glib::ustring tmpfile = File::get_tmp_file (SAVE_EXT);
-  if (!saveGame(tmpfile))
-    {
-      std::cerr<< "Autosave failed, see " << tmpfile << std::endl;
-      return false;
-    }
-  //erase the old autosave file if any, and then plop our new one in place.
-  File::erase(File::getSaveFile(filename));
-  if (File::rename(tmpfile, File::getSaveFile(filename)) == false)
+  // Only the game gets serialized here.  Making the tar file and renaming
+  // it happens on the autosave worker's thread, once it's done with the
+  // last autosave.
+  //
+  // When there's only the one autosave file, the turns that were played go
+  // into a journal beside it, a round at a time, instead of all of them
+  // going into every autosave.
+  //
+  // the worker reports it when the last autosave failed, as it finishes.
+  AutosaveWorker::getInstance()->wait();
+  bool journaled = false;
+  if (Configuration::s_autosave_policy == 1)
+    journaled = RoundJournal::getInstance()->append
+      (RoundJournal::getFilename(File::getSaveFile(filename)), d_id);
+  AutosaveWorker::Job job;
+  job.xmlfile = File::get_tmp_file();
+  XML_Helper helper(job.xmlfile, std::ios::out | std::ios::binary);
+  bool saved = saveWithHelper(helper, journaled);
+  saved &= helper.close();
+  if (!saved)
     {
-      Glib::ustring errmsg = Glib::strerror(errno);
-      std::cerr << String::ucompose(_("Error! can't rename the temporary file `%1' to the autosave file `%2'.  %3"), tmpfile, File::getSaveFile(filename), errmsg) << std::endl;
+      std::cerr<< "Autosave failed, see " << job.xmlfile << std::endl;
       return false;
     }
+  job.infile = getSourceFile();
+  job.setfiles = getSetFiles();
+  job.tmpfile = File::get_tmp_file (SAVE_EXT);
+  job.dest = File::getSaveFile(filename);
+  job.compression = Configuration::s_zipfiles ? Configuration::s_zip_level : 0;
+  AutosaveWorker::getInstance()->start(job);
   return true;
 }
 
@@ -1676,6 +1717,7 @@ void GameScenario::cleanup()
   VectoredUnitlist::deleteInstance();
   GameMap::deleteInstance();
   GameActionlist::deleteInstance();
+  RoundJournal::deleteInstance();
   ScenarioMedia::deleteInstance();
   HeroTemplates::deleteInstance ();
   if (fl_counter)
@@ -1708,4 +1750,7 @@ void GameScenario::support_backward_compatibility()
   FileCompat::getInstance()->support_version
     (FileCompat::GAMESCENARIO, "0.3.2", "0.3.3",
      sigc::ptr_fun(&GameScenario::upgrade));
+  FileCompat::getInstance()->support_version
+    (FileCompat::GAMESCENARIO, "0.3.3", "0.3.4",
+     sigc::ptr_fun(&GameScenario::upgrade));
 }
@@ -125,12 +125,15 @@ class GameScenario: public GameScenarioOptions, public TarFile
         /** Saves the game. See XML_Helper for further explanations.
           *
           * @param filename     the full name of the save game file
+          * @param binary       whether to use the compact binary form
           * @return true if all went well, false otherwise
           */
-        bool saveGame(Glib::ustring filename, Glib::ustring extension = SAVE_EXT) const;
+        bool saveGame(Glib::ustring filename, Glib::ustring extension = SAVE_EXT, bool binary = false) const;
         bool dump (Glib::ustring filename, Glib::ustring extension = SAVE_EXT) const;
         bool loadWithHelper(XML_Helper &helper);
-        bool saveWithHelper(XML_Helper &helper) const;
+        //! Save the game.  When journaled, the turns that are kept in the
+        //! RoundJournal are left out.
+        bool saveWithHelper(XML_Helper &helper, bool journaled = false) const;
 
 	guint32 getPlayMode() const {return d_playmode;};
 	void setPlayMode(GameScenario::PlayMode mode) {d_playmode = mode;};
@@ -179,6 +182,15 @@ class GameScenario: public GameScenarioOptions, public TarFile
 	  bool setupItemRewards();
 	  bool setupStacks(bool hidden_map);
 	  void setupDiplomacy(bool diplomacy);
+	  //! Start an autosave, if the autosave policy asks for one.
+	  /**
+	   * The game is serialized here, and the rest of the autosave is done
+	   * on the AutosaveWorker's thread, which reports any failure itself.
+	   *
+	   * @return false if the game couldn't be serialized, which means
+	   *         this autosave didn't start.  Failures of the worker aren't
+	   *         returned here.
+	   */
 	  bool autoSave();
 
 	  bool loadArmysets(Tar_Helper *t);
@@ -19,6 +19,11 @@
 //  02110-1301, USA.
 #include <sigc++/functors/mem_fun.h>
 #include <iostream>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
 #include "ImageCache.h"
 #include "gui/image-helpers.h"
 #include "playerlist.h"
@@ -43,6 +48,11 @@
 #include "TarFileMaskedImage.h"
 #include "TarFileImage.h"
 
+//! The most threads that prewarm will colour images on.
+#define MAX_PREWARM_THREADS 8
+//! How many times prewarm moves the progress bar along.
+#define PREWARM_TICKS 8
+
 ImageCache* ImageCache::s_instance = 0;
 
 ImageCache* ImageCache::getInstance()
@@ -123,6 +133,7 @@ ImageCache::ImageCache(const ImageCache &c)
   d_medal[0] = new TarFileImage (*c.d_medal[0]);
   d_medal[1] = new TarFileImage (*c.d_medal[1]);
   d_commentator = new TarFileImage (*c.d_commentator);
+  registerCaches();
 }
 
 ImageCache::ImageCache()
@@ -161,6 +172,8 @@ ImageCache::ImageCache()
     dialogcache((sigc::ptr_fun(&DialogPixMaskCacheItem::generate))),
     medalcache((sigc::ptr_fun(&MedalPixMaskCacheItem::generate)))
 {
+    registerCaches();
+
     d_hero_newlevel[0] =
       new TarFileMaskedImage (TarFileMaskedImage::HORIZONTAL_MASK,
                               PixMask::DIMENSION_ANY);
@@ -435,39 +448,8 @@ ImageCache::~ImageCache()
 
 void ImageCache::reset()
 {
-  selectorcache.reset();
-  flagcache.reset();
-  armycache.reset();
-  circledarmycache.reset();
-  circledshipcache.reset();
-  circledstandardcache.reset();
-  tilecache.reset();
-  citycache.reset();
-  towercache.reset();
-  templecache.reset();
-  ruincache.reset();
-  diplomacycache.reset();
-  roadcache.reset();
-  fogcache.reset();
-  bridgecache.reset();
-  cursorcache.reset();
-  shieldcache.reset();
-  prodshieldcache.reset();
-  movebonuscache.reset();
-  shipcache.reset();
-  plantedstandardcache.reset();
-  portcache.reset();
-  signpostcache.reset();
-  bagcache.reset();
-  explosioncache.reset();
-  newlevelcache.reset();
-  defaulttilestylecache.reset();
-  tartancache.reset();
-  emptytartancache.reset();
-  statuscache.reset();
-  gamebuttoncache.reset();
-  dialogcache.reset();
-  medalcache.reset();
+  for (auto c : d_caches)
+    c->reset();
 
   d_cachesize = 0;
   return;
@@ -479,244 +461,278 @@ void ImageCache::checkPictures()
   if (maxcache < MINIMUM_CACHE_SIZE)
     maxcache = MINIMUM_CACHE_SIZE;
 
-  if (d_cachesize < maxcache)
-    return;
-
-  // Now the cache size has been exceeded. We try to guarantee the values
-  // given above and reduce the number of images. Let us start with the
-  // cities
-
-  unsigned int num_players = Playerlist::getInstance()->countPlayersAlive();
-  if (armycache.size() >= 15 * num_players)
-    {
-      d_cachesize -= armycache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (circledarmycache.size() >= 15 * num_players)
-    {
-      d_cachesize -= circledarmycache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (circledshipcache.size() >= num_players)
-    {
-      d_cachesize -= circledshipcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (circledstandardcache.size() >= num_players)
-    {
-      d_cachesize -= circledstandardcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (flagcache.size() >= num_players * MAX_STACK_SIZE)
-    {
-      d_cachesize -= flagcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (citycache.size() >= num_players)
-    {
-      d_cachesize -= citycache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (roadcache.size() >= ROAD_TYPES / 2)
-    {
-      d_cachesize -= roadcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (fogcache.size() >= FOG_TYPES / 2)
-    {
-      d_cachesize -= fogcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (bridgecache.size() >= BRIDGE_TYPES)
-    {
-      d_cachesize -= bridgecache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (shipcache.size() >= MAX_PLAYERS)
-    {
-      d_cachesize -= shipcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (plantedstandardcache.size() >= num_players)
-    {
-      d_cachesize -= plantedstandardcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (portcache.size() > 1)
-    {
-      d_cachesize -= portcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (towercache.size() >= num_players)
-    {
-      d_cachesize -= towercache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (templecache.size() >= TEMPLE_TYPES)
-    {
-      d_cachesize -= templecache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (ruincache.size() >= RUIN_TYPES)
-    {
-      d_cachesize -= ruincache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (signpostcache.size() > 1)
-    {
-      d_cachesize -= signpostcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (bagcache.size() > 1)
-    {
-      d_cachesize -= bagcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (selectorcache.size() >= num_players * MAX_STACK_SIZE)
-    {
-      d_cachesize -= selectorcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (tilecache.size() >= 15*15)
-    {
-      d_cachesize -= tilecache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (diplomacycache.size() >= DIPLOMACY_TYPES)
-    {
-      d_cachesize -= diplomacycache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (cursorcache.size() >= CURSOR_TYPES)
-    {
-      d_cachesize -= cursorcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (shieldcache.size() >= num_players * 3)
+  // Throw out the least recently used images across all of the caches
+  // until we're under budget.  An image's age is divided by the weight of
+  // its cache, so the images that are worth more stay around longer.
+  // We never throw out the image that was just made, it's being returned.
+  guint64 now = PixMaskCacheBase::now();
+  while (d_cachesize >= maxcache)
     {
-      d_cachesize -= shieldcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (prodshieldcache.size() >= PRODUCTION_SHIELD_TYPES)
-    {
-      d_cachesize -= prodshieldcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
-
-  if (movebonuscache.size() >= 8) //around half of 17 different combinations
-    {
-      d_cachesize -= movebonuscache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
+      PixMaskCacheBase *oldest = NULL;
+      double oldest_age = 0;
+      for (auto c : d_caches)
+        {
+          if (c->empty() || c->getOldestStamp() == now)
+            continue;
+          double age = double(now - c->getOldestStamp()) / c->getWeight();
+          if (oldest == NULL || age > oldest_age)
+            {
+              oldest = c;
+              oldest_age = age;
+            }
+        }
+      if (oldest == NULL)
+        break;
+      d_cachesize -= oldest->eraseLeastRecentlyUsed();
     }
+}
 
-  if (explosioncache.size() > 1)
+namespace
+{
+  //! An image for prewarm to colour on a worker thread.
+  struct PrewarmJob
     {
-      d_cachesize -= explosioncache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
+      TarFileMaskedImage::Pixels pixels;
+      std::vector<Gdk::RGBA> colors;
+      PixMask *result;
+    };
+}
 
-  if (newlevelcache.size() > 2)
-    {
-      d_cachesize -= newlevelcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
+void ImageCache::prewarm(sigc::slot<void> tick)
+{
+  if (getenv ("LORDSAWAR_HEADLESS"))
+    return;
 
-  if (defaulttilestylecache.size() >= DEFAULT_TILESTYLE_TYPES)
-    {
-      d_cachesize -= defaulttilestylecache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
+  // Gather up the pixels and colours on this thread.  The worker threads
+  // only ever see raw pixels, because the PixMasks and surfaces that hold
+  // them can't be shared between threads.
+  std::vector<PrewarmJob> jobs;
+  std::vector<ArmyPixMaskCacheItem> armies;
+  std::vector<FlagPixMaskCacheItem> flags;
+  std::vector<ShipPixMaskCacheItem> ships;
+  Playerlist *pl = Playerlist::getInstance();
+  guint32 tileset = GameMap::getInstance()->getTilesetId();
+  guint32 cityset = GameMap::getInstance()->getCitysetId();
 
-  if (tartancache.size() >= MAX_PLAYERS + 1)
+  for (auto p : *pl)
     {
-      d_cachesize -= tartancache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
+      bool broken = false;
+      Armyset *as =
+        Armysetlist::getInstance()->ensureImages(p->getArmyset(), broken);
+      if (!as || broken)
+        continue;
+      for (auto a : *as)
+        {
+          ArmyPixMaskCacheItem i;
+          i.armyset = p->getArmyset();
+          i.army_id = a->getId();
+          i.player_id = p->getId();
+          for (guint32 j = 0; j < MEDAL_TYPES; j++)
+            i.medals[j] = false;
+          i.map = true;
+          i.font_size = 0;
+          i.greyed = false;
+          TarFileMaskedImage *mim =
+            a->getMaskedImage (Shield::Color(p->getId()));
+          PrewarmJob job;
+          job.result = NULL;
+          if (mim && !armycache.contains(i) && mim->getPixels (0, job.pixels))
+            {
+              job.colors = p->getColors ();
+              armies.push_back(i);
+              jobs.push_back(job);
+            }
+        }
     }
 
-  if (emptytartancache.size() >= MAX_PLAYERS + 1)
-    {
-      d_cachesize -= emptytartancache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
+  TarFileMaskedImage *flag = Tilesetlist::getInstance()->get(tileset)->getFlags();
+  for (auto p : *pl)
+    for (guint32 size = 1; size <= MAX_STACK_SIZE; size++)
+      {
+        FlagPixMaskCacheItem i;
+        i.tileset = tileset;
+        i.size = size;
+        i.player_id = p->getId();
+        PrewarmJob job;
+        job.result = NULL;
+        if (flag && !flagcache.contains(i) && flag->getPixels (size - 1, job.pixels))
+          {
+            job.colors = p->getColors ();
+            flags.push_back(i);
+            jobs.push_back(job);
+          }
+      }
 
-  if (statuscache.size() >= 6)
-    {
-      d_cachesize -= statuscache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
+  for (auto p : *pl)
+    {
+      // the neutral player doesn't get a coloured ship.
+      if (p == pl->getNeutral())
+        continue;
+      ShipPixMaskCacheItem i;
+      i.player_id = p->getId();
+      i.armyset = p->getArmyset();
+      TarFileMaskedImage *mim = Armysetlist::getInstance()->getShipPic(i.armyset);
+      PrewarmJob job;
+      job.result = NULL;
+      if (mim && !shipcache.contains(i) && mim->getPixels (i.player_id, job.pixels))
+        {
+          job.colors = p->getColors ();
+          ships.push_back(i);
+          jobs.push_back(job);
+        }
     }
 
-  if (gamebuttoncache.size() >= 12)
+  // Colour the images on the worker threads, and move the progress bar
+  // along while we wait for them.
+  std::atomic<guint32> next(0);
+  guint32 done = 0;
+  std::mutex mutex;
+  std::condition_variable finished;
+  auto work = [&] ()
     {
-      d_cachesize -= gamebuttoncache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
-    }
+      for (guint32 j = next++; j < jobs.size(); j = next++)
+        {
+          jobs[j].result =
+            TarFileMaskedImage::applyMask (jobs[j].pixels, jobs[j].colors);
+          if (jobs[j].result)
+            jobs[j].result->build_mipmaps();
+          std::lock_guard<std::mutex> lock(mutex);
+          done++;
+          finished.notify_one();
+        }
+    };
 
-  if (dialogcache.size() >= 10)
+  guint32 num_threads = std::thread::hardware_concurrency();
+  num_threads = CLAMP(num_threads, 1, MAX_PREWARM_THREADS);
+  if (num_threads > jobs.size())
+    num_threads = jobs.size();
+  std::vector<std::thread> threads;
+  for (guint32 j = 0; j < num_threads; j++)
     {
-      d_cachesize -= dialogcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
+      try
+        {
+          threads.push_back(std::thread(work));
+        }
+      catch (const std::system_error &ex)
+        {
+          break;
+        }
     }
+  if (threads.empty())
+    work();
 
-  if (medalcache.size() >= 6)
+  guint32 step = std::max(guint32(1), guint32(jobs.size() / PREWARM_TICKS));
+  guint32 ticks = 0;
+  while (true)
     {
-      d_cachesize -= medalcache.discardHalf();
-      if (d_cachesize < maxcache)
-        return;
+      guint32 count;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          finished.wait(lock, [&] ()
+                        {return done == jobs.size() ||
+                          done >= (ticks + 1) * step;});
+          count = done;
+        }
+      // don't hold onto the lock while the progress bar redraws.
+      for (; count >= (ticks + 1) * step; ticks++)
+        tick();
+      if (count == jobs.size())
+        break;
     }
+  for (auto &t : threads)
+    t.join();
+
+  guint32 j = 0;
+  for (auto i : armies)
+    d_cachesize += armycache.insert(i, jobs[j++].result);
+  for (auto i : flags)
+    d_cachesize += flagcache.insert(i, jobs[j++].result);
+  for (auto i : ships)
+    d_cachesize += shipcache.insert(i, jobs[j++].result);
+
+  // the city and tower images are plain copies, so we just make them here.
+  Cityset *cs = Citysetlist::getInstance()->get(cityset);
+  for (auto p : *pl)
+    {
+      if (cs->getCity()->getImage(p->getId()))
+        getCityPic(0, p, cityset);
+      if (cs->getRazedCity()->getImage(p->getId()))
+        getCityPic(-1, p, cityset);
+      if (cs->getTower()->getImage(p->getId()))
+        getTowerPic(p, cityset);
+    }
+  checkPictures();
+}
+
+void ImageCache::registerCaches()
+{
+  d_caches.clear();
+  selectorcache.setCategory("selector", 2);
+  d_caches.push_back(&selectorcache);
+  armycache.setCategory("army", 3);
+  d_caches.push_back(&armycache);
+  flagcache.setCategory("flag", 2);
+  d_caches.push_back(&flagcache);
+  circledarmycache.setCategory("circledarmy", 1);
+  d_caches.push_back(&circledarmycache);
+  circledshipcache.setCategory("circledship", 1);
+  d_caches.push_back(&circledshipcache);
+  circledstandardcache.setCategory("circledstandard", 1);
+  d_caches.push_back(&circledstandardcache);
+  tilecache.setCategory("tile", 4);
+  d_caches.push_back(&tilecache);
+  citycache.setCategory("city", 2);
+  d_caches.push_back(&citycache);
+  towercache.setCategory("tower", 2);
+  d_caches.push_back(&towercache);
+  templecache.setCategory("temple", 2);
+  d_caches.push_back(&templecache);
+  ruincache.setCategory("ruin", 2);
+  d_caches.push_back(&ruincache);
+  diplomacycache.setCategory("diplomacy", 1);
+  d_caches.push_back(&diplomacycache);
+  roadcache.setCategory("road", 2);
+  d_caches.push_back(&roadcache);
+  fogcache.setCategory("fog", 2);
+  d_caches.push_back(&fogcache);
+  bridgecache.setCategory("bridge", 2);
+  d_caches.push_back(&bridgecache);
+  cursorcache.setCategory("cursor", 1);
+  d_caches.push_back(&cursorcache);
+  shieldcache.setCategory("shield", 2);
+  d_caches.push_back(&shieldcache);
+  prodshieldcache.setCategory("prodshield", 1);
+  d_caches.push_back(&prodshieldcache);
+  movebonuscache.setCategory("movebonus", 1);
+  d_caches.push_back(&movebonuscache);
+  shipcache.setCategory("ship", 2);
+  d_caches.push_back(&shipcache);
+  plantedstandardcache.setCategory("plantedstandard", 2);
+  d_caches.push_back(&plantedstandardcache);
+  portcache.setCategory("port", 2);
+  d_caches.push_back(&portcache);
+  signpostcache.setCategory("signpost", 2);
+  d_caches.push_back(&signpostcache);
+  bagcache.setCategory("bag", 2);
+  d_caches.push_back(&bagcache);
+  explosioncache.setCategory("explosion", 1);
+  d_caches.push_back(&explosioncache);
+  newlevelcache.setCategory("newlevel", 1);
+  d_caches.push_back(&newlevelcache);
+  defaulttilestylecache.setCategory("defaulttilestyle", 1);
+  d_caches.push_back(&defaulttilestylecache);
+  tartancache.setCategory("tartan", 1);
+  d_caches.push_back(&tartancache);
+  emptytartancache.setCategory("emptytartan", 1);
+  d_caches.push_back(&emptytartancache);
+  statuscache.setCategory("status", 1);
+  d_caches.push_back(&statuscache);
+  gamebuttoncache.setCategory("gamebutton", 1);
+  d_caches.push_back(&gamebuttoncache);
+  dialogcache.setCategory("dialog", 1);
+  d_caches.push_back(&dialogcache);
+  medalcache.setCategory("medal", 1);
+  d_caches.push_back(&medalcache);
 }
 
 PixMask* ImageCache::getSelectorPic(guint32 type, guint32 frame,
@@ -1482,46 +1498,8 @@ PixMask* ImageCache::getSmallTempleImage()
 
 PixMask* ImageCache::greyOut(PixMask* image)
 {
-  int width = image->get_width();
-  int height = image->get_height();
   PixMask* result = image->copy ();
-
-  Glib::RefPtr<Gdk::Pixbuf> d = image->to_pixbuf ();
-  guint8 *data = d->get_pixels ();
-  guint8 *copy = (guint8*)  malloc (height * width * 4 * sizeof(guint8));
-  for (int i = 0; i < height * width * 4; i++)
-    copy[i] = data[i];
-  for (int i = 0; i < width; i++)
-    for (int j = 0; j < height; j++)
-      {
-	const int base = (j * 4) + (i * height * 4);
-
-	if (data[base+3] != 0)
-	  {
-	    guint32 max = 0;
-	    if (copy[base+0] > max)
-	      max = copy[base+0];
-	    else if (copy[base+1] > max)
-	      max = copy[base+1];
-	    else if (copy[base+2] > max)
-	      max = copy[base+2];
-	    int x =  i % 2;
-	    int y = j % 2;
-	    if ((x == 0 && y == 0) || (x == 1 && y == 1))
-	      max = 88;
-	    copy[base+0] = max;
-	    copy[base+1] = max;
-	    copy[base+2] = max;
-	  }
-      }
-  d.reset ();
-  Glib::RefPtr<Gdk::Pixbuf> greyed_out =
-    Gdk::Pixbuf::create_from_data(copy, Gdk::COLORSPACE_RGB, true, 8,
-				  width, height, width * 4);
-
-  result->draw_pixbuf(greyed_out, 0, 0, 0, 0, width, height);
-  free(copy);
-
+  result->grey_out ();
   return result;
 }
 void ImageCache::draw_circle(Cairo::RefPtr<Cairo::Context> cr, double width_percent, int width, int height, Gdk::RGBA color, bool colored, bool mask)
@@ -1784,7 +1762,9 @@ PixMask *FlagPixMaskCacheItem::generate(const FlagPixMaskCacheItem &i)
    * so the ownership stuff has been messed up
    */
   // size of stack starts at 1, but we need the index, which starts at 0
-  return ts->getFlags ()->applyMask (i.size - 1, p);
+  PixMask *s = ts->getFlags ()->applyMask (i.size - 1, p);
+  s->build_mipmaps();
+  return s;
 }
 
 int FlagPixMaskCacheItem::comp(const FlagPixMaskCacheItem &item) const
@@ -1828,6 +1808,8 @@ PixMask *ArmyPixMaskCacheItem::generate(const ArmyPixMaskCacheItem &i)
       int dialogsize = i.font_size * DIALOG_ARMY_PIC_FONTSIZE_MULTIPLE;
       PixMask::scale (s, dialogsize, dialogsize);
     }
+  else
+    s->build_mipmaps();
   return s;
 }
 
@@ -1964,12 +1946,43 @@ PixMask *TilePixMaskCacheItem::generate(const TilePixMaskCacheItem &i)
   PixMask *s;
   Tileset *t = Tilesetlist::getInstance()->get(i.tileset);
   guint32 uts = t->getUnscaledTileSize();
+  if (i.tilesize != uts)
+    {
+      // a zoomed tile is drawn from the mipmaps of the full sized tile,
+      // which stays in the cache from one zoom level to the next.
+      PixMask *full =
+        ImageCache::getInstance()->getTilePic
+        (i.tile_style_id, i.fog_type_id, i.has_bag, i.bag_player_id,
+         i.has_standard, i.standard_player_id, i.stack_size,
+         i.stack_player_id, i.army_type_id, i.has_tower, i.has_ship,
+         i.building_type, i.building_subtype, i.building_tile,
+         i.building_player_id, uts, i.has_grid, i.tileset, i.cityset,
+         i.shieldset, i.stone_type);
+      Cairo::RefPtr<Cairo::Surface> empty =
+        Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, i.tilesize,
+                                     i.tilesize);
+      s = PixMask::create(empty, Cairo::RefPtr<Cairo::Surface>());
+      full->blit_scaled(s->get_pixmap(), Vector<int>(0,0), i.tilesize,
+                        i.tilesize);
+      return s;
+    }
   if (i.fog_type_id == FogMap::ALL)
     s = t->getFog()->getImage(i.fog_type_id - 1)->copy();
   else
     {
-      TileStyle *tilestyle = t->getTileStyle(i.tile_style_id);
-      s = tilestyle->getImage()->copy();
+      if (i.tile_style_id == -1)
+        {
+          //no terrain, just the things that go on top of it.
+          Glib::RefPtr<Gdk::Pixbuf> empty_pic =
+            Gdk::Pixbuf::create(Gdk::COLORSPACE_RGB, true, 8, uts, uts);
+          empty_pic->fill(0x00000000);
+          s = PixMask::create(empty_pic);
+        }
+      else
+        {
+          TileStyle *tilestyle = t->getTileStyle(i.tile_style_id);
+          s = tilestyle->getImage()->copy();
+        }
       const Player *player;
       Cairo::RefPtr<Cairo::Surface> pixmap = s->get_pixmap();
 
@@ -2061,9 +2074,9 @@ PixMask *TilePixMaskCacheItem::generate(const TilePixMaskCacheItem &i)
       if (i.fog_type_id)
         t->getFog()->getImage(i.fog_type_id - 1)->blit(pixmap);
     }
-  int ts = t->getTileSize();
-  if (s->get_width () != ts)
-    s->scale (s, ts, ts);
+  if (s->get_width () != int(uts))
+    s->scale (s, uts, uts);
+  s->build_mipmaps();
   return s;
 }
 
@@ -2119,10 +2132,13 @@ PixMask *CityPixMaskCacheItem::generate(const CityPixMaskCacheItem &i)
 {
   Cityset *cs = Citysetlist::getInstance()->get(i.cityset);
   Player *p = Playerlist::getInstance()->getPlayer(i.player_id);
+  PixMask *s;
   if (i.type == -1)
-    return cs->getRazedCity()->getImage(p->getId())->copy();
+    s = cs->getRazedCity()->getImage(p->getId())->copy();
   else
-    return cs->getCity()->getImage(p->getId())->copy();
+    s = cs->getCity()->getImage(p->getId())->copy();
+  s->build_mipmaps();
+  return s;
 }
 
 int CityPixMaskCacheItem::comp(const CityPixMaskCacheItem &item) const
@@ -2140,7 +2156,9 @@ int CityPixMaskCacheItem::comp(const CityPixMaskCacheItem &item) const
 PixMask *TowerPixMaskCacheItem::generate(const TowerPixMaskCacheItem &i)
 {
   Cityset *cs = Citysetlist::getInstance()->get(i.cityset);
-  return cs->getTower()->getImage(i.player_id)->copy();
+  PixMask *s = cs->getTower()->getImage(i.player_id)->copy();
+  s->build_mipmaps();
+  return s;
 }
 
 int TowerPixMaskCacheItem::comp(const TowerPixMaskCacheItem &item) const
@@ -2618,21 +2636,24 @@ int MoveBonusPixMaskCacheItem::comp(const MoveBonusPixMaskCacheItem &item) const
 
 PixMask *ShipPixMaskCacheItem::generate(const ShipPixMaskCacheItem &i)
 {
+  PixMask *s;
   // copy the pixmap including player colors
   if (i.player_id != MAX_PLAYERS)
     {
       TarFileMaskedImage * mim =
         Armysetlist::getInstance()->getShipPic(i.armyset);
-      return mim->applyMask (i.player_id,
-                             Playerlist::getInstance()->getPlayer(i.player_id));
+      s = mim->applyMask (i.player_id,
+                          Playerlist::getInstance()->getPlayer(i.player_id));
     }
   else //we can put a neutral ship in the water in the editor
     {
       TarFileMaskedImage * mim =
         Armysetlist::getInstance()->getShipPic(i.armyset);
 
-      return mim->getImage ()->copy ();
+      s = mim->getImage ()->copy ();
     }
+  s->build_mipmaps();
+  return s;
 }
 
 int ShipPixMaskCacheItem::comp(const ShipPixMaskCacheItem &item) const
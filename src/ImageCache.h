@@ -170,6 +170,26 @@ class ImageCache
         //! Get the current cache size, the maximum is in Configuration::s_cacheSize
         guint32 getCacheSize() const {return d_cachesize;}
 
+        //! Get the caches, to see their sizes, hit rates and evictions.
+        const std::vector<PixMaskCacheBase*> &getCaches() const {return d_caches;}
+
+        //! Make the images that the big map needs, before the game starts.
+        /**
+         * The army, stack flag and ship images of every player are coloured
+         * on worker threads and put into the cache, and the city and tower
+         * images are copied in, so that the first frames of the game don't
+         * have to make them one at a time.
+         *
+         * This is only worth doing when the game is going to be shown, so
+         * the gui does it after it loads a game to play, while its progress
+         * bar is still showing.
+         *
+         * @param tick  Called on this thread every so often while the images
+         *              are being made, to move a progress bar along.  The
+         *              gui passes GameScenario::load_tick.
+         */
+        void prewarm(sigc::slot<void> tick);
+
         /** Method for getting the army picture from the cache
           * 
           * This method returns either the cached image of the given type or
@@ -431,6 +451,11 @@ class ImageCache
 
 	PixMask* getSelectorPic(guint32 type, guint32 frame, const Player *p);
 
+        //! Get the image of a map tile.
+        /**
+         * When tile_style_id is -1 the image has no terrain in it, just
+         * the things that go on top of the terrain.
+         */
 	PixMask* getTilePic(int tile_style_id, int fog_type_id, bool has_bag, int bag_player_id, bool has_standard, int standard_player_id, int stack_size, int stack_player_id, int army_type_id, bool has_tower, bool has_ship, Maptile::Building building_type, int building_subtype, Vector<int> building_tile, int building_player_id, guint32 tilesize, bool has_grid, guint32 tileset, guint32 cityset, guint32 shieldset, int stone_type);
 	PixMask* getTilePic(int tile_style_id, int fog_type_id, bool has_bag, int bag_player_id, bool has_standard, int standard_player_id, int stack_size, int stack_player_id, int army_type_id, bool has_tower, bool has_ship, Maptile::Building building_type, int building_subtype, Vector<int> building_tile, int building_player_id, guint32 tilesize, bool has_grid, int stone_type);
 
@@ -512,6 +537,9 @@ class ImageCache
 
         //! Checks if the cache has exceeded the maximum size and reduce it.
         void checkPictures();
+
+        //! Name and weigh the caches, and put them in d_caches.
+        void registerCaches();
         
         bool loadDiplomacyImages();
         bool loadCursorImages();
@@ -525,6 +553,9 @@ class ImageCache
         static ImageCache* s_instance;
 
         guint32 d_cachesize;
+
+        //! All of the caches below, for going through them in a loop.
+        std::vector<PixMaskCacheBase*> d_caches;
   
         PixMaskCache<SelectorPixMaskCacheItem> selectorcache;
         PixMaskCache<ArmyPixMaskCacheItem> armycache;
@@ -23,6 +23,15 @@
 #include <gdkmm.h>
 #include "ucompose.hpp"
 #include "gui/main.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//! The colour that to_pixbuf treats as transparent.
+#define TRANSPARENT_KEY 0xffff57cc
+
+//! build_mipmaps stops halving an image when it gets this small.
+#define MIPMAP_MIN_SIZE 4
 
 
 PixMask::PixMask(Glib::RefPtr<Gdk::Pixbuf> p)
@@ -135,6 +144,52 @@ PixMask::PixMask(Glib::ustring filename, bool &broken)
       broken = true;
       return;
     }
+  use_pixbuf(pixbuf);
+}
+
+PixMask::PixMask(const std::string &data, Glib::ustring name, bool &broken)
+     : width(0), height(0)
+{
+  if (getenv ("LORDSAWAR_HEADLESS"))
+    return;
+  Glib::RefPtr<Gdk::Pixbuf> pixbuf = load_pixbuf(data, name, broken);
+  if (!pixbuf)
+    return;
+  use_pixbuf(pixbuf);
+}
+
+Glib::RefPtr<Gdk::Pixbuf> PixMask::load_pixbuf(const std::string &data,
+                                               Glib::ustring name,
+                                               bool &broken)
+{
+  if (getenv ("LORDSAWAR_HEADLESS"))
+    {
+      broken = true;
+      return Glib::RefPtr<Gdk::Pixbuf>();
+    }
+  // the loader sniffs out whether it's a png or an svg.
+  Glib::RefPtr<Gdk::PixbufLoader> loader = Gdk::PixbufLoader::create();
+  Glib::RefPtr<Gdk::Pixbuf> pixbuf;
+  try
+    {
+      loader->write((const guint8*)data.data(), data.size());
+      loader->close();
+      pixbuf = loader->get_pixbuf();
+    }
+  catch (const Glib::Exception &ex)
+    {
+      pixbuf.clear();
+    }
+  if (!pixbuf)
+    {
+      std::cerr << String::ucompose(_("Could not load image file `%1'."), name) << std::endl;
+      broken = true;
+    }
+  return pixbuf;
+}
+
+void PixMask::use_pixbuf(Glib::RefPtr<Gdk::Pixbuf> pixbuf)
+{
   pixmap = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, pixbuf->get_width(), pixbuf->get_height());
   gc = Cairo::Context::create(pixmap);
   Gdk::Cairo::set_source_pixbuf(gc, pixbuf, 0, 0);
@@ -151,6 +206,11 @@ PixMask* PixMask::create(Glib::ustring filename, bool &broken)
   return new PixMask(filename, broken);
 }
 
+PixMask* PixMask::create(const std::string &data, Glib::ustring name, bool &broken)
+{
+  return new PixMask(data, name, broken);
+}
+
 PixMask* PixMask::create(Glib::RefPtr<Gdk::Pixbuf> pixbuf)
 {
   return new PixMask(pixbuf);
@@ -208,6 +268,33 @@ void PixMask::blit(Vector<int> tile, int ts, Cairo::RefPtr<Cairo::Surface> p, Ve
   blit (LwRectangle(src.x, src.y, ts, ts), p, dest);
 }
 
+void PixMask::blit_scaled(Cairo::RefPtr<Cairo::Surface> dest, Vector<int> pos,
+                          int xsize, int ysize)
+{
+  // start from the smallest image that's still big enough, so that cairo
+  // never has to shrink anything by more than half.
+  Cairo::RefPtr<Cairo::Surface> src = pixmap;
+  int w = width;
+  int h = height;
+  for (auto level : mipmaps)
+    {
+      if (level->get_width() < xsize || level->get_height() < ysize)
+        break;
+      src = level;
+      w = level->get_width();
+      h = level->get_height();
+    }
+  Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create(dest);
+  context->rectangle(pos.x, pos.y, xsize, ysize);
+  context->clip();
+  context->translate(pos.x, pos.y);
+  context->scale(double(xsize) / w, double(ysize) / h);
+  context->set_source(src, 0, 0);
+  Cairo::RefPtr<Cairo::SurfacePattern>::cast_dynamic
+    (context->get_source())->set_filter(Cairo::FILTER_BILINEAR);
+  context->paint();
+}
+
 void PixMask::scale(PixMask*& p, int xsize, int ysize, Gdk::InterpType interp)
 {
   PixMask *scaled = p->scale(xsize, ysize, interp);
@@ -227,6 +314,16 @@ void PixMask::scale(PixMask*& p, double perc, Gdk::InterpType interp)
 
 PixMask * PixMask::scale(int xsize, int ysize, Gdk::InterpType interp)
 {
+  if (mipmaps.empty() == false && xsize <= width && ysize <= height)
+    {
+      Cairo::RefPtr<Cairo::Surface> empty =
+        Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, xsize, ysize);
+      PixMask *pix = PixMask::create(empty, Cairo::RefPtr<Cairo::Surface>());
+      blit_scaled(pix->get_pixmap(), Vector<int>(0,0), xsize, ysize);
+      pix->set_unscaled_width(get_unscaled_width());
+      pix->set_unscaled_height(get_unscaled_height());
+      return pix;
+    }
   Glib::RefPtr<Gdk::Pixbuf> pixbuf = to_pixbuf();
   PixMask *pix = PixMask::create(pixbuf->scale_simple(xsize, ysize, interp));
   pix->set_unscaled_width(get_unscaled_width());
@@ -260,10 +357,220 @@ void PixMask::draw_pixbuf(Glib::RefPtr<Gdk::Pixbuf> pixbuf, int src_x, int src_y
   delete p;
 }
 
+Cairo::RefPtr<Cairo::ImageSurface> PixMask::get_image_surface()
+{
+  Cairo::RefPtr<Cairo::ImageSurface> image =
+    Cairo::RefPtr<Cairo::ImageSurface>::cast_dynamic(pixmap);
+  if (!image || image->get_format() != Cairo::FORMAT_ARGB32)
+    {
+      //our pixmaps are all image surfaces, but just in case.
+      image = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, width, height);
+      Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create(image);
+      context->set_source (pixmap, 0, 0);
+      context->paint();
+      pixmap = image;
+      gc = Cairo::Context::create(pixmap);
+    }
+  image->flush();
+  return image;
+}
+
+/*
+ * The pixels of an image surface are premultiplied ARGB, one guint32 each.
+ * Multiplying a premultiplied colour by a factor is the same as multiplying
+ * the plain colour, so these kernels work on the pixels as they are.
+ */
+
+//! Divide a product of two 8-bit values by 255, rounding to the nearest.
+static inline guint32 div255(guint32 x)
+{
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+//! Draw n mask pixels multiplied by a colour over n destination pixels.
+/**
+ * The colour factors go from 0 to 256.
+ */
+static void colored_mask_over(const guint32 *src, guint32 *dst, int n,
+                              guint32 fr, guint32 fg, guint32 fb)
+{
+  int i = 0;
+#ifdef __SSE2__
+  // four pixels at a time, two in each register as 16-bit channels.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i factor = _mm_set_epi16(256, fr, fg, fb, 256, fr, fg, fb);
+  const __m128i c255 = _mm_set1_epi16(255);
+  const __m128i c128 = _mm_set1_epi16(128);
+  const __m128i key = _mm_set1_epi32(TRANSPARENT_KEY);
+  for (; i + 4 <= n; i += 4)
+    {
+      __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+      __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+      s = _mm_andnot_si128(_mm_cmpeq_epi32(s, key), s);
+      __m128i half[2];
+      for (int h = 0; h < 2; h++)
+        {
+          __m128i sc = h ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+          __m128i dc = h ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+          sc = _mm_srli_epi16(_mm_mullo_epi16(sc, factor), 8);
+          __m128i a = _mm_shufflelo_epi16(sc, _MM_SHUFFLE(3, 3, 3, 3));
+          a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+          __m128i t = _mm_add_epi16(_mm_mullo_epi16(dc, _mm_sub_epi16(c255, a)), c128);
+          t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+          half[h] = _mm_add_epi16(sc, t);
+        }
+      _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(half[0], half[1]));
+    }
+#endif
+  for (; i < n; i++)
+    {
+      guint32 s = src[i];
+      guint32 a = s >> 24;
+      if (a == 0 || s == TRANSPARENT_KEY)
+        continue;
+      guint32 r = (((s >> 16) & 0xff) * fr) >> 8;
+      guint32 g = (((s >> 8) & 0xff) * fg) >> 8;
+      guint32 b = ((s & 0xff) * fb) >> 8;
+      guint32 d = dst[i];
+      guint32 ia = 255 - a;
+      dst[i] = ((a + div255((d >> 24) * ia)) << 24) |
+        ((r + div255(((d >> 16) & 0xff) * ia)) << 16) |
+        ((g + div255(((d >> 8) & 0xff) * ia)) << 8) |
+        (b + div255((d & 0xff) * ia));
+    }
+}
+
+static guint32 color_factor(double c)
+{
+  if (c <= 0)
+    return 0;
+  if (c >= 1)
+    return 256;
+  return guint32(c * 256.0 + 0.5);
+}
+
+void PixMask::draw_colored_mask(PixMask *mask, Gdk::RGBA color)
+{
+  if (mask->width != width || mask->height != height)
+    return;
+  int stride = 0;
+  const unsigned char *data = mask->get_pixels(stride);
+  draw_colored_mask(data, stride, color);
+}
+
+void PixMask::draw_colored_mask(const unsigned char *mask, int stride,
+                                Gdk::RGBA color)
+{
+  Cairo::RefPtr<Cairo::ImageSurface> dst = get_image_surface();
+  guint32 fr = color_factor(color.get_red());
+  guint32 fg = color_factor(color.get_green());
+  guint32 fb = color_factor(color.get_blue());
+  unsigned char *dst_data = dst->get_data();
+  for (int y = 0; y < height; y++)
+    colored_mask_over((const guint32*)(mask + y * stride),
+                      (guint32*)(dst_data + y * dst->get_stride()),
+                      width, fr, fg, fb);
+  dst->mark_dirty();
+}
+
+const unsigned char *PixMask::get_pixels(int &stride)
+{
+  Cairo::RefPtr<Cairo::ImageSurface> image = get_image_surface();
+  stride = image->get_stride();
+  return image->get_data();
+}
+
+void PixMask::grey_out()
+{
+  Cairo::RefPtr<Cairo::ImageSurface> image = get_image_surface();
+  unsigned char *data = image->get_data();
+  for (int y = 0; y < height; y++)
+    {
+      guint32 *row = (guint32*)(data + y * image->get_stride());
+      for (int x = 0; x < width; x++)
+        {
+          guint32 p = row[x];
+          guint32 a = p >> 24;
+          if (a == 0)
+            continue;
+          // every other pixel is a dark grey, and the rest take the
+          // brightness of their first channel that has any.
+          guint32 v;
+          if ((x + y) % 2 == 0)
+            v = div255(88 * a);
+          else if ((p >> 16) & 0xff)
+            v = (p >> 16) & 0xff;
+          else if ((p >> 8) & 0xff)
+            v = (p >> 8) & 0xff;
+          else
+            v = p & 0xff;
+          guint32 ia = 255 - a;
+          guint32 r = v + div255(((p >> 16) & 0xff) * ia);
+          guint32 g = v + div255(((p >> 8) & 0xff) * ia);
+          guint32 b = v + div255((p & 0xff) * ia);
+          row[x] = ((a + div255(a * ia)) << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+  image->mark_dirty();
+}
+
 int PixMask::get_depth()
 {
     return 32;
 }
+
+guint32 PixMask::get_byte_size()
+{
+  guint32 size = get_depth() / 8 * width * height;
+  for (auto level : mipmaps)
+    size += level->get_stride() * level->get_height();
+  return size;
+}
+
+// Average each 2x2 block of premultiplied pixels into one pixel.  The red
+// and blue channels are summed together in one word, and the alpha and
+// green in another; four bytes add up to ten bits, so they can't overlap.
+static void halve_row(const guint32 *top, const guint32 *bottom, guint32 *dst,
+                      int n)
+{
+  for (int i = 0; i < n; i++)
+    {
+      guint32 a = top[2 * i];
+      guint32 b = top[2 * i + 1];
+      guint32 c = bottom[2 * i];
+      guint32 d = bottom[2 * i + 1];
+      guint32 rb = (a & 0x00ff00ff) + (b & 0x00ff00ff) +
+        (c & 0x00ff00ff) + (d & 0x00ff00ff) + 0x00020002;
+      guint32 ag = ((a >> 8) & 0x00ff00ff) + ((b >> 8) & 0x00ff00ff) +
+        ((c >> 8) & 0x00ff00ff) + ((d >> 8) & 0x00ff00ff) + 0x00020002;
+      dst[i] = ((rb >> 2) & 0x00ff00ff) | (((ag >> 2) & 0x00ff00ff) << 8);
+    }
+}
+
+void PixMask::build_mipmaps()
+{
+  mipmaps.clear();
+  Cairo::RefPtr<Cairo::ImageSurface> src = get_image_surface();
+  while (src->get_width() / 2 >= MIPMAP_MIN_SIZE &&
+         src->get_height() / 2 >= MIPMAP_MIN_SIZE)
+    {
+      int w = src->get_width() / 2;
+      int h = src->get_height() / 2;
+      Cairo::RefPtr<Cairo::ImageSurface> dst =
+        Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, w, h);
+      dst->flush();
+      const unsigned char *src_data = src->get_data();
+      unsigned char *dst_data = dst->get_data();
+      for (int y = 0; y < h; y++)
+        halve_row((const guint32*)(src_data + 2 * y * src->get_stride()),
+                  (const guint32*)(src_data + (2 * y + 1) * src->get_stride()),
+                  (guint32*)(dst_data + y * dst->get_stride()), w);
+      dst->mark_dirty();
+      mipmaps.push_back(dst);
+      src = dst;
+    }
+}
      
 Vector<int> PixMask::get_dim() const
 {
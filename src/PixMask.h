@@ -19,6 +19,7 @@
 #ifndef PIXMASK_H
 #define PIXMASK_H
 
+#include <vector>
 #include <gtkmm.h>
 #include "vector.h"
 #include "rectangle.h"
@@ -48,12 +49,26 @@ class PixMask
      int get_unscaled_height() {return unscaled_height;};
      int get_depth();
 
+     //! How many bytes the pixels take up, including any mipmaps.
+     guint32 get_byte_size();
+
      static PixMask* create(Glib::ustring file, bool &broken);
+     static PixMask* create(const std::string &data, Glib::ustring name,
+                            bool &broken);
      static PixMask* create(Glib::RefPtr<Gdk::Pixbuf> buf);
      static PixMask* create(Cairo::RefPtr<Cairo::Surface> pixmap,
 					 Cairo::RefPtr<Cairo::Surface> mask);
      static bool checkDimension (Glib::ustring file, DimensionType t, guint32 rows = 0);
      static bool checkFormat (Glib::ustring file);
+
+     //! Make a pixbuf from the bytes of a png or svg file.
+     /**
+      * The name is only used in the error message when the bytes can't
+      * be made into an image.
+      */
+     static Glib::RefPtr<Gdk::Pixbuf> load_pixbuf(const std::string &data,
+                                                  Glib::ustring name,
+                                                  bool &broken);
      PixMask* copy();
 
      //! convert this pixmask to a pixbuf.
@@ -62,6 +77,44 @@ class PixMask
      //! draw a pixbuf onto this pixmask.
      void draw_pixbuf(Glib::RefPtr<Gdk::Pixbuf> pixbuf, int src_x, int src_y, int dest_x, int dest_y, int width, int height);
 
+     //! draw a mask onto this pixmask, with its colour multiplied by color.
+     /**
+      * The mask must be the same size as this pixmask.
+      */
+     void draw_colored_mask(PixMask *mask, Gdk::RGBA color);
+
+     //! draw the pixels of a mask onto this pixmask, like above.
+     /**
+      * The pixels are premultiplied ARGB32 rows that are stride bytes apart,
+      * with the same width and height as this pixmask.
+      */
+     void draw_colored_mask(const unsigned char *mask, int stride,
+                            Gdk::RGBA color);
+
+     //! get the pixels of this pixmask, so another thread can read them.
+     /**
+      * The pixels are premultiplied ARGB32, and they are good for as long as
+      * this pixmask isn't changed or deleted.
+      */
+     const unsigned char *get_pixels(int &stride);
+
+     //! draw a grey, checkered version of this pixmask on top of itself.
+     void grey_out();
+
+     //! make a chain of images that are each half the size of the last one.
+     /**
+      * Scaling this pixmask down afterwards starts from the smallest image
+      * in the chain that is still at least as big as the new size, so that
+      * it's a cheap draw with cairo rather than a trip through a pixbuf.
+      *
+      * This should be done when the image is finished, before it goes into
+      * a cache.  Changing the image afterwards leaves the chain out of date,
+      * and copies of the pixmask don't get the chain.
+      */
+     void build_mipmaps();
+
+     bool has_mipmaps() const {return mipmaps.empty() == false;}
+
      //! scale a pixmask in place (alters pixmask)
      static void scale(PixMask*& pixmask, int xsize, int ysize, Gdk::InterpType intper = Gdk::INTERP_BILINEAR);
      static void scale(PixMask*& pixmask, double percent, Gdk::InterpType intper = Gdk::INTERP_BILINEAR);
@@ -72,6 +125,9 @@ class PixMask
      void blit_centered(Cairo::RefPtr<Cairo::Surface> pixmap, Vector<int> pos);
       //blit a tile's worth of imagery from this pixmask to a pixmap.
      void blit(Vector<int> tile, int ts, Cairo::RefPtr<Cairo::Surface> pixmap, Vector<int> dest = Vector<int>(0,0));
+     //! draw this pixmask onto a pixmap, stretched to the given size.
+     void blit_scaled(Cairo::RefPtr<Cairo::Surface> pixmap, Vector<int> pos,
+                      int xsize, int ysize);
      void reset_scale () {unscaled_width = width; unscaled_height = height;}
      Vector<int> get_dim() const;
      Vector<int> get_unscaled_dim() const;
@@ -110,6 +166,12 @@ class PixMask
       */
      PixMask(Glib::ustring filename, bool &broken);
 
+     //! Loading constructor.
+     /**
+      * Load the pixmask from the bytes of a file that is already in memory.
+      */
+     PixMask(const std::string &data, Glib::ustring name, bool &broken);
+
      void set_unscaled_width(guint32 w) {unscaled_width = w;};
      void set_unscaled_height(guint32 h) {unscaled_height = h;};
     
@@ -122,11 +184,20 @@ class PixMask
     int unscaled_width;
     int unscaled_height;
 
+     //! The images that build_mipmaps made, biggest first.
+     std::vector<Cairo::RefPtr<Cairo::ImageSurface> > mipmaps;
+
      //! return a stretched copy of this pixmask.
      PixMask* scale(int xsize, int ysize, 
 		    Gdk::InterpType interp = Gdk::INTERP_NEAREST);
      
      void blit(LwRectangle src, Cairo::RefPtr<Cairo::Surface> pixmap, Vector<int> dest);
+
+     //! make the pixmap and the mask for a freshly loaded pixbuf.
+     void use_pixbuf(Glib::RefPtr<Gdk::Pixbuf> pixbuf);
+
+     //! get the pixmap as an image surface that we can change directly.
+     Cairo::RefPtr<Cairo::ImageSurface> get_image_surface();
 };
 
 #endif
@@ -21,26 +21,108 @@
 
 #include <list>
 #include <map>
+#include <glibmm/ustring.h>
 #include <sigc++/trackable.h>
 #include <sigc++/slot.h>
 #include "PixMask.h"
+#include "draw-stats.h"
+
+//! The part of a PixMaskCache that doesn't depend on the model.
+/**
+ * Every time an image is fetched from any cache it is stamped with the
+ * time on a clock shared by all of the caches.  This lets the ImageCache
+ * find the least recently used image across all of its caches, and keep
+ * them all within one budget of bytes.
+ *
+ * Each cache has a name and a weight.  The weight says how much the images
+ * are worth keeping: an image with a weight of 2 stays around for twice
+ * as long as an image with a weight of 1 that was last used at the same
+ * time.
+ */
+class PixMaskCacheBase
+{
+public:
+    PixMaskCacheBase()
+      : cachesize (0), hits (0), misses (0), evictions (0), weight (1) {}
+    virtual ~PixMaskCacheBase() {}
+
+    //! Set the name of the cache and how much its images are worth keeping.
+    void setCategory(Glib::ustring n, guint32 w) {name = n; weight = w;}
+
+    Glib::ustring getName() const {return name;}
+    guint32 getWeight() const {return weight;}
+
+    //! How many bytes of images are in the cache.
+    guint32 getCacheSize() const {return cachesize;}
+
+    //! How many times an image was found already in the cache.
+    guint64 getHits() const {return hits;}
+
+    //! How many times an image had to be generated.
+    guint64 getMisses() const {return misses;}
+
+    //! How many images have been thrown out of the cache.
+    guint64 getEvictions() const {return evictions;}
+
+    //! The fraction of fetches that were found in the cache.
+    double getHitRate() const
+      {return hits + misses ? double(hits) / double(hits + misses) : 0.0;}
+
+    virtual bool empty() const = 0;
+
+    //! When the least recently used image in this cache was last used.
+    virtual guint64 getOldestStamp() const = 0;
+
+    //! Throw out the least recently used image, and return its size.
+    virtual guint32 eraseLeastRecentlyUsed() = 0;
+
+    virtual void reset() = 0;
+
+    //! The time on the clock that all of the caches share.
+    static guint64 now() {return clock();}
+
+protected:
+    static guint64 tick() {return ++clock();}
+
+    guint32 cachesize;
+    guint64 hits;
+    guint64 misses;
+    guint64 evictions;
+
+private:
+    static guint64 &clock() {static guint64 c = 0; return c;}
+
+    Glib::ustring name;
+    guint32 weight;
+};
 
 //! Template for caching PixMask objects along with a model of each object.
-template<class T> class PixMaskCache: public std::list<T>, public sigc::trackable
+/**
+ * The list holds the models in the order they were last used, the least
+ * recently used one first.  The map goes from a model to its PixMask and
+ * to its place in the list, so that finding, touching and throwing out an
+ * item doesn't involve searching the list.
+ */
+template<class T> class PixMaskCache: public PixMaskCacheBase, public sigc::trackable
 {
 public:
     typedef sigc::slot<PixMask*, T> Generator;
 
-    PixMaskCache(Generator g): generate (g), cachesize (0) {}
+    PixMaskCache(Generator g): generate (g) {}
 
     PixMaskCache(const PixMaskCache &c)
-      : std::list<T>(), sigc::trackable (), generate (c.generate), cachesize (c.cachesize)
+      : PixMaskCacheBase (c), sigc::trackable (), generate (c.generate)
       {
-        for (typename std::map<T, PixMask *>::const_iterator i = c.surfaces.begin ();
-             i != c.surfaces.end (); ++i)
+        for (typename std::list<Node>::const_iterator i = c.lru.begin ();
+             i != c.lru.end (); ++i)
           {
-            this->push_back (T((*i).first));
-            surfaces[this->back ()] = (*i).second->copy ();
+            lru.push_back (*i);
+            Entry &e = surfaces[(*i).item];
+            PixMask *orig = (*c.surfaces.find((*i).item)).second.pixmask;
+            e.pixmask = orig->copy ();
+            if (orig->has_mipmaps ())
+              e.pixmask->build_mipmaps ();
+            e.it = --lru.end ();
           }
       }
 
@@ -49,24 +131,29 @@ public:
         reset();
       }
 
-    guint32 getCacheSize() const {return cachesize;}
+    size_t size() const {return lru.size();}
+    bool empty() const {return lru.empty();}
+
+    guint64 getOldestStamp() const
+      {return lru.empty() ? now() : lru.front().stamp;}
 
     guint32 eraseLeastRecentlyUsed()
       {
         guint32 siz = 0;
-        if (this->empty() == false)
+        if (lru.empty() == false)
           {
-            T item = *(this->begin());
-            this->erase(this->begin());
-            typename std::map<T,PixMask*>::iterator i = surfaces.find(item);
+            typename std::map<T,Entry>::iterator i =
+              surfaces.find(lru.front().item);
+            lru.pop_front();
             if (i != surfaces.end())
               {
-                PixMask *s = (*i).second;
+                PixMask *s = (*i).second.pixmask;
                 surfaces.erase(i);
                 if (s)
                   {
-                    siz = s->get_depth()/8 * (s->get_width() * s->get_height());
+                    siz = s->get_byte_size();
                     cachesize -= siz;
+                    evictions++;
                     delete s;
                   }
               }
@@ -76,7 +163,7 @@ public:
 
     void reset()
       {
-        while (this->empty() == false)
+        while (lru.empty() == false)
           this->eraseLeastRecentlyUsed();
         cachesize = 0;
       }
@@ -84,52 +171,89 @@ public:
     PixMask* get(T &item, guint32 &size_added)
       {
         //see if we already made it.
-        typename PixMaskCache<T>::iterator it = std::find(this->begin(), this->end(), item);
-        if (it != this->end())
+        typename std::map<T,Entry>::iterator i = surfaces.find(item);
+        if (i != surfaces.end())
           {
             //looks like we made it.  barry manilow.
             //put the item in last place (last touched)
-            this->erase(it);
-            this->push_back(item);
-            return surfaces[item];
+            hits++;
+            DrawStats::count(DrawStats::IMAGE_CACHE_HITS);
+            lru.splice(lru.end(), lru, (*i).second.it);
+            (*i).second.it->stamp = tick();
+            return (*i).second.pixmask;
           }
         else
           {
             //generate the image
+            misses++;
+            DrawStats::count(DrawStats::IMAGE_CACHE_MISSES);
             PixMask *s = (generate)(item);
             if (s)
               {
-                surfaces[item] = s;
-                this->push_back(item);
-                size_added = (s->get_width() * s->get_height()) * 
-                  (s->get_depth()/8);
+                Node n;
+                n.item = item;
+                n.stamp = tick();
+                lru.push_back(n);
+                Entry &e = surfaces[item];
+                e.pixmask = s;
+                e.it = --lru.end();
+                size_added = s->get_byte_size();
                 cachesize += size_added;
               }
             return s;
           }
       }
 
-    guint32 discardHalf()
+    //! Do we already have an image for the given model?
+    bool contains(const T &item) const
       {
-        guint32 siz = 0;
-        if (this->size() <= 1)
-          //this is necessary so we don't delete the pixmask we just created
-          return siz;
-        if (this->empty() == false)
+        return surfaces.find(item) != surfaces.end();
+      }
+
+    //! Add an image that was made somewhere else, unless we have one.
+    /**
+     * The cache takes ownership of the image either way.
+     *
+     * @return the number of bytes the cache grew by.
+     */
+    guint32 insert(const T &item, PixMask *s)
+      {
+        if (!s)
+          return 0;
+        if (contains(item))
           {
-            guint32 half = cachesize / 2;
-            while (cachesize > half)
-              {
-                siz += this->eraseLeastRecentlyUsed();
-                if (this->size () == 1)
-                  break;
-              }
+            delete s;
+            return 0;
           }
-        return siz;
+        Node n;
+        n.item = item;
+        n.stamp = tick();
+        lru.push_back(n);
+        Entry &e = surfaces[item];
+        e.pixmask = s;
+        e.it = --lru.end();
+        guint32 size_added = s->get_byte_size();
+        cachesize += size_added;
+        return size_added;
       }
+
 private:
-    std::map<T, PixMask *> surfaces;
+    //! A model and when its image was last used.
+    struct Node
+    {
+      T item;
+      guint64 stamp;
+    };
+
+    //! A cached image and where its model is in the list.
+    struct Entry
+    {
+      PixMask *pixmask;
+      typename std::list<Node>::iterator it;
+    };
+
+    std::list<Node> lru;
+    std::map<T, Entry> surfaces;
     Generator generate;
-    guint32 cachesize;
 };
 #endif
@@ -86,9 +86,13 @@ bool TarFileImage::load (Glib::ustring bname)
   bool broken = false;
   if (name.empty () == true)
     return broken;
-  Glib::ustring filename = tarfile->getFile(bname, broken);
+  // the image is made straight from the bytes in the tar file.
+  const std::string *data = tarfile->getFileContents(bname);
+  if (data == NULL)
+    return broken;
+  PixMask *p = PixMask::create (*data, bname, broken);
   if (!broken)
-    broken = loadFromFile (filename);
+    useBackingImage (p, "");
   return broken;
 }
 
@@ -99,20 +103,23 @@ bool TarFileImage::loadFromFile (Glib::ustring filename)
     return false;
   PixMask *p = PixMask::create (filename, broken);
   if (!broken)
-    {
-      if (image)
-        delete image;
-      image = p;
-      file_on_disk = filename;
-      int size =
-        p->get_unscaled_width () / number_of_frames;
-      frames.resize (number_of_frames);
-      dimension = Vector<int>(size,size);
-    }
+    useBackingImage (p, filename);
 
   return broken;
 }
 
+void TarFileImage::useBackingImage (PixMask *p, Glib::ustring filename)
+{
+  if (image)
+    delete image;
+  image = p;
+  file_on_disk = filename;
+  int size =
+    p->get_unscaled_width () / number_of_frames;
+  frames.resize (number_of_frames);
+  dimension = Vector<int>(size,size);
+}
+
 void TarFileImage::instantiateImages (Vector<int> scale_to_dimension)
 {
   if (!image)
@@ -148,13 +148,16 @@ public:
 
 private:
 
+  //! Take on P as the backing image, and size up the frames from it
+  void useBackingImage (PixMask *p, Glib::ustring filename);
+
   //! The opened tar file
   Tar_Helper *tarfile;
 
   //! The basename of the archive member holding the image
   Glib::ustring name;
 
-  //! When we extract the file from the tar file, this is where it is
+  //! When the image was loaded from a file on disk, this is where it is
   Glib::ustring file_on_disk;
 
   //! What we want to scale the images to
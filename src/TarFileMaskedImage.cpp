@@ -95,9 +95,13 @@ bool TarFileMaskedImage::load (Glib::ustring bname)
   bool broken = false;
   if (name.empty () == true)
     return broken;
-  Glib::ustring filename = tarfile->getFile(bname, broken);
+  // the image is made straight from the bytes in the tar file.
+  const std::string *data = tarfile->getFileContents(bname);
+  if (data == NULL)
+    return broken;
+  PixMask *p = PixMask::create (*data, bname, broken);
   if (!broken)
-    broken = loadFromFile (filename);
+    useBackingImage (p, "");
   return broken;
 }
 
@@ -108,28 +112,31 @@ bool TarFileMaskedImage::loadFromFile (Glib::ustring filename)
     return false;
   PixMask *p = PixMask::create (filename, broken);
   if (!broken)
-    {
-      if (image)
-        delete image;
-      image = p;
-      file_on_disk = filename;
-      int size = 0;
-      if (orientation == HORIZONTAL_MASK)
-        {
-          calculated_number_of_frames = 1;
-          size = p->get_unscaled_width () / (maskcount + 1);
-        }
-      else if (orientation == VERTICAL_MASK)
-        {
-          size = p->get_unscaled_height () / (maskcount + 1);
-          calculated_number_of_frames = p->get_unscaled_width () / size;
-        }
-      dimension = Vector<int>(size,size);
-    }
+    useBackingImage (p, filename);
 
   return broken;
 }
 
+void TarFileMaskedImage::useBackingImage (PixMask *p, Glib::ustring filename)
+{
+  if (image)
+    delete image;
+  image = p;
+  file_on_disk = filename;
+  int size = 0;
+  if (orientation == HORIZONTAL_MASK)
+    {
+      calculated_number_of_frames = 1;
+      size = p->get_unscaled_width () / (maskcount + 1);
+    }
+  else if (orientation == VERTICAL_MASK)
+    {
+      size = p->get_unscaled_height () / (maskcount + 1);
+      calculated_number_of_frames = p->get_unscaled_width () / size;
+    }
+  dimension = Vector<int>(size,size);
+}
+
 void TarFileMaskedImage::instantiateImages (Vector<int> scale_to_dimension)
 {
   uninstantiateImages ();
@@ -340,32 +347,7 @@ PixMask* TarFileMaskedImage::applyMask(std::vector<PixMask*> frame, std::vector<
   it++;
   for (auto color : colors)
     {
-      ma = *it;
-
-      Glib::RefPtr<Gdk::Pixbuf> maskbuf = ma->to_pixbuf();
-
-      guint8 *data = maskbuf->get_pixels();
-      guint8 *copy = (guint8*)  malloc (height * width * 4 * sizeof(guint8));
-      for (int i = 0; i < height * width * 4; i++)
-        copy[i] = data[i];
-      for (int i = 0; i < width; i++)
-        for (int j = 0; j < height; j++)
-          {
-            const int base = (j * 4) + (i * height * 4);
-
-            if (copy[base+3] != 0)
-              {
-                copy[base+0] = color.get_red() *copy[base+0];
-                copy[base+1] = color.get_green() * copy[base+1];
-                copy[base+2] = color.get_blue() * copy[base+2];
-              }
-          }
-
-      Glib::RefPtr<Gdk::Pixbuf> coloredmask =
-        Gdk::Pixbuf::create_from_data(copy, Gdk::COLORSPACE_RGB, true, 8,
-                                      width, height, width * 4);
-      result->draw_pixbuf(coloredmask, 0, 0, 0, 0, width, height);
-      free(copy);
+      result->draw_colored_mask(*it, color);
       it++;
       if (it == frame.end ())
         break;
@@ -374,6 +356,50 @@ PixMask* TarFileMaskedImage::applyMask(std::vector<PixMask*> frame, std::vector<
   return result;
 }
 
+bool TarFileMaskedImage::getPixels (guint32 i, Pixels &pixels) const
+{
+  if (i >= frames.size () || frames[i].size () <= 1)
+    return false;
+  PixMask *im = frames[i][0];
+  pixels.width = im->get_width ();
+  pixels.height = im->get_height ();
+  pixels.image = im->get_pixels (pixels.image_stride);
+  pixels.masks.clear ();
+  pixels.mask_strides.clear ();
+  for (auto it = frames[i].begin () + 1; it != frames[i].end (); it++)
+    {
+      if ((*it)->get_width () != pixels.width ||
+          (*it)->get_height () != pixels.height)
+        return false;
+      int stride = 0;
+      pixels.masks.push_back ((*it)->get_pixels (stride));
+      pixels.mask_strides.push_back (stride);
+    }
+  return true;
+}
+
+PixMask* TarFileMaskedImage::applyMask (const Pixels &pixels,
+                                        std::vector<Gdk::RGBA> colors)
+{
+  // wrap the borrowed pixels in surfaces of our own; the PixMask copies
+  // them, so nothing we share with the main thread gets touched.
+  unsigned char *image = const_cast<unsigned char*>(pixels.image);
+  unsigned char *mask = const_cast<unsigned char*>(pixels.masks.front ());
+  PixMask *result =
+    PixMask::create (Cairo::ImageSurface::create (image, Cairo::FORMAT_ARGB32,
+                                                  pixels.width, pixels.height,
+                                                  pixels.image_stride),
+                     Cairo::ImageSurface::create (mask, Cairo::FORMAT_ARGB32,
+                                                  pixels.width, pixels.height,
+                                                  pixels.mask_strides.front ()));
+  if (!result)
+    return NULL;
+  for (guint32 j = 0; j < colors.size () && j < pixels.masks.size (); j++)
+    result->draw_colored_mask (pixels.masks[j], pixels.mask_strides[j],
+                               colors[j]);
+  return result;
+}
+
 bool TarFileMaskedImage::copy (TarFile *t, TarFileMaskedImage *dest)
 {
   bool success = false;
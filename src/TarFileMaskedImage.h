@@ -101,6 +101,37 @@ public:
   PixMask *applyMask (guint32 i, Player *p) const;
   PixMask *applyMask (guint32 i, std::vector<Gdk::RGBA> colors) const;
 
+  //! The pixels of an image and of its masks.
+  /**
+   * These are borrowed from the PixMasks of a frame so that the masks can
+   * be applied on another thread, without going through the PixMasks.
+   */
+  struct Pixels
+    {
+      int width;
+      int height;
+      const unsigned char *image;
+      int image_stride;
+      std::vector<const unsigned char *> masks;
+      std::vector<int> mask_strides;
+    };
+
+  //! Get the pixels of the image at the given index, and its masks.
+  /**
+   * @return false if there isn't an image with masks at that index.
+   */
+  bool getPixels (guint32 i, Pixels &pixels) const;
+
+  //! Apply the masks onto the image in the given colors.
+  /**
+   * Unlike the other applyMask methods, this one can be called on any
+   * thread, as long as the image that the pixels came from is left alone.
+   *
+   * @return a pointer to a new PixMask that must be deleted.
+   */
+  static PixMask *applyMask (const Pixels &pixels,
+                             std::vector<Gdk::RGBA> colors);
+
   //! Return all of the images
   std::vector<PixMask*> getImages () const
     { std::vector<PixMask*> o; for (auto f : frames) o.push_back (f.front ()); return o; }
@@ -201,6 +232,9 @@ public:
   static void uninstantiate (Glib::ustring name, std::vector<TarFileMaskedImage*> images);
 private:
 
+  //! Take on P as the backing image, and size up the frames from it
+  void useBackingImage (PixMask *p, Glib::ustring filename);
+
   //! The orientation of the masked image
   MaskOrientation orientation;
 
@@ -210,7 +244,7 @@ private:
   //! The basename of the archive member holding the image
   Glib::ustring name;
 
-  //! When we extract the file from the tar file, this is where it is
+  //! When the image was loaded from a file on disk, this is where it is
   Glib::ustring file_on_disk;
 
   //! What we want to scale the images to
@@ -249,14 +249,15 @@ void Tile::instantiateImages(int tilesize, Tar_Helper *t, bool scale,
   broken = false;
   for (iterator it = begin(); it != end(); ++it)
     {
-      Glib::ustring file = "";
       if ((*it)->getName().empty() == false && !broken)
         {
-          file = t->getFile((*it)->getName(), broken);
+          const std::string *data = t->getFileContents((*it)->getName());
+          if (data == NULL)
+            continue;
+          Glib::RefPtr<Gdk::Pixbuf> row =
+            PixMask::load_pixbuf(*data, (*it)->getName(), broken);
           if (!broken)
-            (*it)->loadImages(tilesize, file, scale, broken);
-          if (file.empty() == false)
-            File::erase(file);
+            (*it)->loadImages(tilesize, row, scale);
         }
     }
 }
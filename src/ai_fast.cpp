@@ -86,14 +86,14 @@ AI_Fast::~AI_Fast()
         delete d_diplomacy;
 }
 
-bool AI_Fast::save(XML_Helper* helper) const
+bool AI_Fast::save(XML_Helper* helper, guint32 skip_history) const
 {
     bool retval = true;
 
     retval &= helper->openTag(Player::d_tag);
     retval &= helper->saveData("join", d_join);
     retval &= helper->saveData("maniac", d_maniac);
-    retval &= Player::save(helper);
+    retval &= Player::save(helper, skip_history);
     retval &= helper->closeTag();
 
     return retval;
@@ -73,7 +73,7 @@ class AI_Fast : public RealPlayer
 	virtual bool isComputer() const {return true;};
 
         //! Saves data, the method is for saving additional data.
-        bool save(XML_Helper* helper) const;
+        bool save(XML_Helper* helper, guint32 skip_history = 0) const;
 
 	virtual void abortTurn();
         virtual bool startTurn();
@@ -605,6 +605,7 @@ void Armyset::instantiateImages(bool scale, bool &broken)
   if (ret == false)
     broken = false;
   t.Close();
+  setInstantiated (true);
 }
       
 bool Armyset::loadSelectorPics (Tar_Helper *t)
@@ -646,6 +647,7 @@ void Armyset::uninstantiateImages()
     }
 
   d_bag->uninstantiateImages ();
+  setInstantiated (false);
 }
 
 void Armyset::switchArmysetForRuinKeeper(Army *army, const Armyset *armyset)
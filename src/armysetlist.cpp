@@ -138,19 +138,6 @@ TarFileMaskedImage *Armysetlist::getStandardPic (guint32 id)
   return NULL;
 }
 
-void Armysetlist::instantiateImages(bool &broken)
-{
-  broken = false;
-  for (iterator it = begin(); it != end(); ++it)
-    {
-      if (!broken)
-        {
-          if ((*it)->validate () == true)
-            (*it)->instantiateImages(true, broken);
-        }
-    }
-}
-
 void Armysetlist::uninstantiateImages()
 {
   for (iterator it = begin(); it != end(); ++it)
@@ -85,7 +85,6 @@ class Armysetlist : public SetList<Armyset>, public sigc::trackable
         std::vector<PixMask*> getStandardMasks (guint32 id);
         guint32 getTileSize(guint32 id);
 
-	void instantiateImages(bool &broken);
 	void uninstantiateImages();
 
     private:
@@ -0,0 +1,93 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#include <iostream>
+#include <errno.h>
+#include "autosave-worker.h"
+#include "tarfile.h"
+#include "File.h"
+#include "ucompose.hpp"
+#include "defs.h"
+
+AutosaveWorker* AutosaveWorker::s_instance = 0;
+
+AutosaveWorker* AutosaveWorker::getInstance()
+{
+  if (!s_instance)
+    s_instance = new AutosaveWorker();
+
+  return s_instance;
+}
+
+void AutosaveWorker::deleteInstance()
+{
+  if (!s_instance)
+    return;
+
+  delete s_instance;
+  s_instance = NULL;
+}
+
+AutosaveWorker::AutosaveWorker()
+ : d_thread(NULL), d_result(true)
+{
+}
+
+AutosaveWorker::~AutosaveWorker()
+{
+  wait();
+}
+
+bool AutosaveWorker::wait()
+{
+  if (d_thread)
+    {
+      d_thread->join();
+      delete d_thread;
+      d_thread = NULL;
+    }
+  bool result = d_result;
+  d_result = true;
+  return result;
+}
+
+bool AutosaveWorker::start(const Job &job)
+{
+  bool result = wait();
+  d_thread = new std::thread(&AutosaveWorker::run, this, job);
+  return result;
+}
+
+void AutosaveWorker::run(Job job)
+{
+  Glib::ustring tmptar = job.tmpfile + ".tar";
+  if (TarFile::saveTarFrom(job.infile, job.xmlfile, tmptar, job.tmpfile,
+                           job.setfiles, job.compression) == false)
+    {
+      std::cerr<< "Autosave failed, see " << tmptar << std::endl;
+      d_result = false;
+      return;
+    }
+  //erase the old autosave file if any, and then plop our new one in place.
+  File::erase(job.dest);
+  if (File::rename(job.tmpfile, job.dest) == false)
+    {
+      Glib::ustring errmsg = Glib::strerror(errno);
+      std::cerr << String::ucompose(_("Error! can't rename the temporary file `%1' to the autosave file `%2'.  %3"), job.tmpfile, job.dest, errmsg) << std::endl;
+      d_result = false;
+    }
+}
@@ -0,0 +1,95 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#pragma once
+#ifndef AUTOSAVE_WORKER_H
+#define AUTOSAVE_WORKER_H
+
+#include <thread>
+#include <vector>
+#include <glibmm.h>
+
+//! Finishes off autosave files on a worker thread.
+/**
+ * The game is serialized into a temporary file on the main thread, which
+ * is quick.  Putting it into a tar file with the sets, compressing it and
+ * renaming it into place is slower, so that happens on a worker thread
+ * while the game carries on.
+ *
+ * Only one autosave is worked on at a time.  Handing over a new one waits
+ * for the last one to finish first.
+ *
+ * Implemented as a singleton.
+ */
+class AutosaveWorker
+{
+ public:
+    //! Everything the worker thread needs to know to finish an autosave.
+    struct Job
+      {
+        //! The serialized game.
+        Glib::ustring xmlfile;
+        //! The tar file that the game was loaded from.
+        Glib::ustring infile;
+        //! The configuration files of the sets that the game uses.
+        std::vector<Glib::ustring> setfiles;
+        //! Where the tar file gets made.
+        Glib::ustring tmpfile;
+        //! The autosave file that gets replaced.
+        Glib::ustring dest;
+        //! How much to compress the autosave file, or 0.
+        int compression;
+      };
+
+    //! Returns the singleton instance.  Creates a new one if needed.
+    static AutosaveWorker *getInstance();
+
+    //! Explicitly deletes the singleton instance, after it's done saving.
+    static void deleteInstance();
+
+    //! Wait for the autosave in progress, if any, to finish.
+    /**
+     * @return false if the last autosave failed.
+     */
+    bool wait();
+
+    //! Start finishing off an autosave on the worker thread.
+    /**
+     * This waits for the last autosave to finish first.
+     *
+     * @return false if the last autosave failed.
+     */
+    bool start(const Job &job);
+
+ protected:
+    AutosaveWorker();
+    ~AutosaveWorker();
+
+ private:
+    //! Make the tar file and rename it into place.  Runs on the worker.
+    void run(Job job);
+
+    static AutosaveWorker *s_instance;
+
+    //! The worker thread, when there's an autosave in progress.
+    std::thread *d_thread;
+
+    //! How the last autosave went.  Only read after the thread is joined.
+    bool d_result;
+};
+
+#endif // AUTOSAVE_WORKER_H
@@ -49,20 +49,32 @@
 #include "MapBackpack.h"
 #include "GameScenarioOptions.h"
 #include "tileset.h"
+#include "cityset.h"
+#include "shieldset.h"
 #include "TarFileImage.h"
+#include "png-writer.h"
+#include "draw-stats.h"
 
 #include <iostream>
+#include <algorithm>
 //#define debug(x) {std::cerr<<__FILE__<<": "<<__LINE__<<": "<<x<<std::endl<<std::flush;}
 #define debug(x)
 
+//! About how many bytes of the map saveAsBitmap draws at a time.
+#define BITMAP_BAND_SIZE (32 * 1024 * 1024)
+
 bool BigMap::s_show_hidden_ruins;
 
 BigMap::BigMap(bool headless)
  : d_headless (headless), d_renderer(0), view (LwRectangle (0, 0, 0, 0)),
     view_pos (Vector<int>(0,0)), buffer(0), input_locked (false),
-    blank_screen (false), d_grid_toggled (false),
+    blank_screen (false), d_grid_toggled (false), d_no_fog (false),
     image (Gtk::Allocation(0, 0, 320, 200)), deltax (0), deltay (0),
-    d_fighting(LocationBox(Vector<int>(-1,-1)))
+    d_all_dirty (true), d_fighting(LocationBox(Vector<int>(-1,-1))),
+    d_drawn_tilesize (0), d_drawn_viewer_id (0), d_drawn_active_player_id (0),
+    d_drawn_active_stack_id (0), d_drawn_active_stack_pos (Vector<int>(-1,-1)),
+    d_drawn_tileset_id (0), d_drawn_cityset_id (0), d_drawn_shieldset_id (0),
+    d_chunk_clock (0)
 {
 }
 
@@ -70,6 +82,8 @@ BigMap::~BigMap()
 {
     if (buffer)
       buffer.clear();
+    if (d_tiles)
+      d_tiles.clear();
 
     delete d_renderer;
 }
@@ -119,10 +133,18 @@ void BigMap::set_view(LwRectangle new_view)
     buffer = Cairo::Surface::create (empty, Cairo::CONTENT_COLOR_ALPHA, buffer_view.w * tilesize, buffer_view.h * tilesize);
     buffer_gc = Cairo::Context::create(buffer);
 
+    // the map tiles are kept in a surface of the same size, so that we can
+    // draw the overlays on a fresh copy of them every time.
+    if (d_tiles)
+      d_tiles.clear();
+    d_tiles = Cairo::Surface::create (empty, Cairo::CONTENT_COLOR_ALPHA, buffer_view.w * tilesize, buffer_view.h * tilesize);
+    d_all_dirty = true;
+
     //now create the part that will go out to the gtk::image
     if (outgoing)
       outgoing.clear();
     outgoing = Cairo::Surface::create(buffer, Cairo::CONTENT_COLOR_ALPHA, image.get_width(), image.get_height());
+    DrawStats::count(DrawStats::SURFACES_ALLOCATED, 4);
 
 
     if (d_renderer)
@@ -137,6 +159,7 @@ void BigMap::clip_viewable_buffer(Cairo::RefPtr<Cairo::Surface> pixmap, Vector<i
   out_gc->rectangle(0, 0, image.get_width(), image.get_height());
   out_gc->clip();
   out_gc->save();
+  out_gc->set_operator(Cairo::OPERATOR_SOURCE);
   out_gc->set_source(pixmap, -pos.x, -pos.y);
   out_gc->rectangle (0, 0, image.get_width(), image.get_height());
   out_gc->clip();
@@ -147,6 +170,7 @@ void BigMap::clip_viewable_buffer(Cairo::RefPtr<Cairo::Surface> pixmap, Vector<i
 
 void BigMap::draw(bool redraw_buffer)
 {
+    DrawStats::Timer timer(DrawStats::BIGMAP_DRAW);
     // no size and buffer yet, return
     if (!buffer || d_headless)
         return;
@@ -167,8 +191,6 @@ void BigMap::draw(bool redraw_buffer)
 
     // blit the visible part of buffer to the screen
     Vector<int> p = view_pos - (buffer_view.pos * tilesize);
-    outgoing.clear();
-    outgoing = Cairo::Surface::create(buffer, Cairo::CONTENT_COLOR_ALPHA, image.get_width(), image.get_height());
     clip_viewable_buffer(buffer, p, outgoing);
 
     if (blank_screen)
@@ -186,6 +208,8 @@ void BigMap::draw(bool redraw_buffer)
 void BigMap::screen_size_changed(Gtk::Allocation box)
 {
     int ts = GameMap::getInstance()->getTileSize();
+    bool resized = box.get_width() != image.get_width() ||
+      box.get_height() != image.get_height();
 
     LwRectangle new_view = view;
     
@@ -202,6 +226,14 @@ void BigMap::screen_size_changed(Gtk::Allocation box)
 	view_changed.emit(view);
       }
     image = box;
+
+    // we keep the outgoing surface from one draw to the next, so make it
+    // again when the size of the screen changes.
+    if (resized && buffer)
+      {
+        outgoing = Cairo::Surface::create(buffer, Cairo::CONTENT_COLOR_ALPHA, image.get_width(), image.get_height());
+        DrawStats::count(DrawStats::SURFACES_ALLOCATED);
+      }
 }
 
 Vector<int> BigMap::get_view_pos_from_view()
@@ -305,10 +337,8 @@ void BigMap::draw_stack(Stack *s, Cairo::RefPtr<Cairo::Surface> surface)
       //we don't show the army or the flag if we're in fortified tent.
       if (s->hasShip())
 	{
-          PixMask *ship = ImageCache::getInstance()->getShipPic(player)->copy();
-          ship->scale (ship, tilesize, tilesize);
-          ship->blit(surface, p);
-          delete ship;
+          PixMask *ship = ImageCache::getInstance()->getShipPic(player);
+          ship->blit_scaled(surface, p, tilesize, tilesize);
 	}
       else
 	{
@@ -323,10 +353,8 @@ void BigMap::draw_stack(Stack *s, Cairo::RefPtr<Cairo::Surface> surface)
 		  tile->getBuilding() != Maptile::RUIN &&
 		  tile->getBuilding() != Maptile::TEMPLE)
                 {
-                  PixMask *tower = ImageCache::getInstance()->getTowerPic(player)->copy();
-                  tower->scale (tower, tilesize, tilesize);
-                  tower->blit(surface, p);
-                  delete tower;
+                  PixMask *tower = ImageCache::getInstance()->getTowerPic(player);
+                  tower->blit_scaled(surface, p, tilesize, tilesize);
                 }
 	      else
 		show_army = true;
@@ -335,10 +363,8 @@ void BigMap::draw_stack(Stack *s, Cairo::RefPtr<Cairo::Surface> surface)
 	  if (show_army == true)
 	    {
 	      Army *a = *s->begin();
-	      PixMask *armypic = ImageCache::getInstance()->getArmyPic(a)->copy();
-              armypic->scale (armypic, tilesize, tilesize);
-              armypic->blit(surface, p);
-              delete armypic;
+	      PixMask *armypic = ImageCache::getInstance()->getArmyPic(a);
+              armypic->blit_scaled(surface, p, tilesize, tilesize);
 	    }
 	}
 
@@ -358,19 +384,158 @@ void BigMap::draw_stack(Stack *s, Cairo::RefPtr<Cairo::Surface> surface)
             stacksize = MAX_STACK_SIZE;
           if (stacksize > 0)
             {
-              PixMask *flag = ImageCache::getInstance()->getFlagPic(stacksize, player)->copy();
-              flag->scale (flag, tilesize, tilesize);
-              flag->blit(surface, p);
-              delete flag;
-
+              PixMask *flag = ImageCache::getInstance()->getFlagPic(stacksize, player);
+              flag->blit_scaled(surface, p, tilesize, tilesize);
             }
         }
     }
 }
 
+void BigMap::mark_dirty(LwRectangle tiles)
+{
+  if (d_all_dirty)
+    return;
+  // past a point it's quicker to draw everything than to go through the list
+  if (d_dirty.size() >= 64)
+    {
+      d_all_dirty = true;
+      d_dirty.clear();
+      return;
+    }
+  d_dirty.push_back(tiles);
+}
+
+void BigMap::mark_all_dirty()
+{
+  d_all_dirty = true;
+  d_dirty.clear();
+  for (auto &c : d_chunks)
+    c.second.dirty = true;
+}
+
+void BigMap::check_for_changes()
+{
+  // the tiles are drawn from the viewing player's point of view, and without
+  // the active stack (it gets drawn by after_draw), so when these change we
+  // have to draw the tiles again.
+  guint32 tilesize = GameMap::getInstance()->getTileSize();
+  if (tilesize != d_drawn_tilesize)
+    {
+      d_drawn_tilesize = tilesize;
+      d_all_dirty = true;
+    }
+
+  // the chunks are drawn with the images of the sets, and the editor can
+  // switch a set for another one with the same tile size.
+  guint32 tileset_id = GameMap::getTileset()->getId();
+  guint32 cityset_id = GameMap::getCityset()->getId();
+  guint32 shieldset_id = GameMap::getShieldset()->getId();
+  if (tileset_id != d_drawn_tileset_id || cityset_id != d_drawn_cityset_id ||
+      shieldset_id != d_drawn_shieldset_id)
+    {
+      d_drawn_tileset_id = tileset_id;
+      d_drawn_cityset_id = cityset_id;
+      d_drawn_shieldset_id = shieldset_id;
+      d_chunks.clear();
+      d_all_dirty = true;
+    }
+
+  Player *viewer = Playerlist::getViewingplayer();
+  guint32 viewer_id = viewer ? viewer->getId() : 0;
+  Player *active = Playerlist::getActiveplayer();
+  guint32 active_id = active ? active->getId() : 0;
+  if (viewer_id != d_drawn_viewer_id || active_id != d_drawn_active_player_id)
+    {
+      // which hidden ruins show up depends on who is looking.
+      d_drawn_viewer_id = viewer_id;
+      d_drawn_active_player_id = active_id;
+      mark_all_dirty();
+    }
+
+  Stack *stack = active ? active->getActivestack() : NULL;
+  guint32 stack_id = stack ? stack->getId() : 0;
+  Vector<int> stack_pos = stack ? stack->getPos() : Vector<int>(-1,-1);
+  if (stack_id != d_drawn_active_stack_id ||
+      stack_pos != d_drawn_active_stack_pos)
+    {
+      if (d_drawn_active_stack_pos != Vector<int>(-1,-1))
+        mark_dirty(d_drawn_active_stack_pos);
+      if (stack_pos != Vector<int>(-1,-1))
+        mark_dirty(stack_pos);
+      d_drawn_active_stack_id = stack_id;
+      d_drawn_active_stack_pos = stack_pos;
+    }
+}
+
+void BigMap::scroll_tiles()
+{
+  // move what we've already drawn over to where it goes in the new view,
+  // using the buffer as a scratch surface.
+  int tilesize = GameMap::getInstance()->getTileSize();
+  Vector<int> delta = (d_tiles_view.pos - buffer_view.pos) * tilesize;
+  buffer_gc->save();
+  buffer_gc->set_operator(Cairo::OPERATOR_SOURCE);
+  buffer_gc->set_source(d_tiles, delta.x, delta.y);
+  buffer_gc->paint();
+  buffer_gc->restore();
+  Cairo::RefPtr<Cairo::Context> tiles_gc = Cairo::Context::create(d_tiles);
+  tiles_gc->set_operator(Cairo::OPERATOR_SOURCE);
+  tiles_gc->set_source(buffer, 0, 0);
+  tiles_gc->paint();
+
+  // and the strips that have scrolled into view need drawing.
+  LwRectangle kept = intersect(d_tiles_view, buffer_view);
+  if (kept.w == 0 || kept.h == 0)
+    {
+      d_all_dirty = true;
+      return;
+    }
+  const LwRectangle &b = buffer_view;
+  if (kept.y > b.y)
+    mark_dirty(LwRectangle(b.x, b.y, b.w, kept.y - b.y));
+  if (kept.y + kept.h < b.y + b.h)
+    mark_dirty(LwRectangle(b.x, kept.y + kept.h, b.w,
+                           b.y + b.h - (kept.y + kept.h)));
+  if (kept.x > b.x)
+    mark_dirty(LwRectangle(b.x, kept.y, kept.x - b.x, kept.h));
+  if (kept.x + kept.w < b.x + b.w)
+    mark_dirty(LwRectangle(kept.x + kept.w, kept.y,
+                           b.x + b.w - (kept.x + kept.w), kept.h));
+}
+
+void BigMap::update_tiles()
+{
+  check_for_changes();
+  if (d_all_dirty == false && d_tiles_view.pos != buffer_view.pos)
+    scroll_tiles();
+
+  if (d_all_dirty)
+    draw_buffer (buffer_view, d_tiles);
+  else
+    {
+      for (auto r : d_dirty)
+        {
+          LwRectangle tiles = intersect(r, buffer_view);
+          if (tiles.w > 0 && tiles.h > 0)
+            draw_buffer_tiles(tiles, d_tiles);
+        }
+    }
+  d_dirty.clear();
+  d_all_dirty = false;
+  d_tiles_view = buffer_view;
+}
+
 void BigMap::draw_buffer()
 {
-  draw_buffer (buffer_view, buffer);
+  update_tiles();
+
+  // start with the map tiles, and then draw the overlays on top of them.
+  buffer_gc->save();
+  buffer_gc->set_operator(Cairo::OPERATOR_SOURCE);
+  buffer_gc->set_source(d_tiles, 0, 0);
+  buffer_gc->paint();
+  buffer_gc->restore();
+
   // if we're hidden map this is hosed.
   after_draw();
   if (blank_screen == false)
@@ -380,134 +545,93 @@ void BigMap::draw_buffer()
       if (d_fighting.getPos() != Vector<int>(-1,-1))
         {
           Vector<int> p = tile_to_buffer_pos(d_fighting.getPos());
-          PixMask *tmp = gc->getExplosionPic()->copy();
-          if (d_fighting.getSize() > 1)
-            {
-              PixMask::scale(tmp, d_fighting.getSize() * tilesize,
-                             d_fighting.getSize() * tilesize);
-            }
-          tmp->blit(buffer, p);
-          delete tmp;
+          int size = d_fighting.getSize() * tilesize;
+          gc->getExplosionPic()->blit_scaled(buffer, p, size, size);
         }
     }
 }
 
-bool BigMap::saveAsBitmap(Glib::ustring filename)
+bool BigMap::saveAsBitmap(Glib::ustring filename, double scale, bool fog)
 {
   int tilesize = GameMap::getInstance()->getTileSize();
-  int width = GameMap::getWidth() * tilesize;
-  int height = GameMap::getHeight() * tilesize;
-  Cairo::RefPtr<Cairo::Surface> empty = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, width, height);
-  Cairo::RefPtr<Cairo::Surface> surf = Cairo::Surface::create (empty, Cairo::CONTENT_COLOR_ALPHA, width, height);
-  
+  int map_width = GameMap::getWidth() * tilesize;
+  int map_height = GameMap::getHeight() * tilesize;
+  if (scale <= 0)
+    return false;
+  int width = std::max(1, int(round(map_width * scale)));
+  int height = std::max(1, int(round(map_height * scale)));
+  PngWriter png(filename, width, height);
+  if (png.isBroken())
+    return false;
+
+  // Draw the map a band of rows at a time, and hand each band to the png
+  // file as soon as it's drawn.  The bands are a whole number of chunks
+  // high so that every chunk of terrain gets drawn once.
+  int band_rows = CHUNK_SIZE *
+    std::max(1, BITMAP_BAND_SIZE / (map_width * 4 * tilesize * CHUNK_SIZE));
+  Cairo::RefPtr<Cairo::ImageSurface> band =
+    Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, map_width,
+                                 band_rows * tilesize);
+  Cairo::RefPtr<Cairo::Context> band_gc = Cairo::Context::create(band);
+  Cairo::RefPtr<Cairo::ImageSurface> scaled = band;
+  if (width != map_width || height != map_height)
+    scaled = Cairo::ImageSurface::create
+      (Cairo::FORMAT_ARGB32, width,
+       int(ceil(band_rows * tilesize * double(height) / map_height)) + 2);
+
   bool orig_grid = d_grid_toggled;
+  LwRectangle orig_buffer_view = buffer_view;
   d_grid_toggled = false;
-  draw_buffer(LwRectangle (0, 0, GameMap::getWidth(), GameMap::getHeight()), surf);
+  d_no_fog = !fog;
+  int written = 0;
+  for (int y = 0; y < GameMap::getHeight(); y += band_rows)
+    {
+      int rows = std::min(band_rows, GameMap::getHeight() - y);
+      band_gc->save();
+      band_gc->set_operator(Cairo::OPERATOR_CLEAR);
+      band_gc->paint();
+      band_gc->restore();
+      // the tiles are drawn relative to the buffer's view.
+      buffer_view = LwRectangle(0, y, GameMap::getWidth(), rows);
+      draw_buffer(buffer_view, band);
+      d_chunks.clear();
+
+      int bottom = height;
+      if (y + rows < GameMap::getHeight())
+        bottom = int(round((y + rows) * tilesize * double(height) / map_height));
+      if (scaled != band)
+        {
+          Cairo::RefPtr<Cairo::Context> cr = Cairo::Context::create(scaled);
+          cr->set_operator(Cairo::OPERATOR_SOURCE);
+          cr->translate(0, -written);
+          cr->scale(double(width) / map_width, double(height) / map_height);
+          cr->set_source(band, 0, y * tilesize);
+          Cairo::RefPtr<Cairo::SurfacePattern>::cast_dynamic
+            (cr->get_source())->set_extend(Cairo::EXTEND_PAD);
+          cr->paint();
+        }
+      scaled->flush();
+      if (png.write(scaled->get_data(), scaled->get_stride(),
+                    bottom - written) == false)
+        break;
+      written = bottom;
+    }
+  buffer_view = orig_buffer_view;
   d_grid_toggled = orig_grid;
-  Glib::RefPtr<Gdk::Pixbuf> pixbuf = Gdk::Pixbuf::create(surf, 0, 0, width, height);
-  pixbuf->save (filename, "png");
-  return true;
+  d_no_fog = false;
+  return png.close();
 }
 
-void BigMap::draw_buffer_tile(Vector<int> tile, Cairo::RefPtr<Cairo::Surface> surface)
+void BigMap::get_terrain(Vector<int> tile, TerrainTile &terrain)
 {
-  guint32 tilesize = GameMap::getInstance()->getTileSize();
   Player *viewing = Playerlist::getViewingplayer();
-  ImageCache *gc = ImageCache::getInstance();
-  int tile_style_id = GameMap::getInstance()->getTile(tile)->getTileStyleId();
-  int fog_type_id = 0;
-  if (Playerlist::getViewingplayer()->getType() != Player::HUMAN &&
-      GameScenarioOptions::s_hidden_map == true)
-    fog_type_id = FogMap::ALL;
-  else
-    fog_type_id = viewing->getFogMap()->getShadeTile(tile);
-
-  bool has_bag = false;
-  guint32 bag_player_id = 0;
-  bool has_standard = false;
-  guint32 player_standard_id = 0;
-  int stack_size = -1;
-  int stack_player_id = -1;
-  int army_type_id = -1;
-  bool has_ship = false;
-  bool has_tower = false;
-  auto building_type = GameMap::getInstance()->getTile(tile)->getBuilding();
+  Maptile *m = GameMap::getInstance()->getTile(tile);
+  auto building_type = m->getBuilding();
   Vector<int> building_tile = Vector<int>(-1,-1);
   int building_subtype = -1;
   int building_player_id = -1;
   int stone_type = -1;
 
-  if (fog_type_id == FogMap::ALL)
-    {
-      //short circuit.  the tile is completely fogged.
-      PixMask *pixmask =
-	gc->getTilePic(tile_style_id, fog_type_id, has_bag, bag_player_id,
-                       has_standard, player_standard_id, stack_size,
-                       stack_player_id, army_type_id, has_tower, has_ship,
-                       building_type, building_subtype, building_tile,
-                       building_player_id, tilesize, d_grid_toggled,
-                       stone_type);
-      pixmask->blit(surface, tile_to_buffer_pos(tile));
-      return;
-    }
-  MapBackpack *backpack = GameMap::getInstance()->getTile(tile)->getBackpack();
-  if (backpack && backpack->empty() == false)
-    {
-      bool standard_planted = false;
-      Item *flag = backpack->getFirstPlantedItem();
-      if (flag)
-	standard_planted = true;
-
-      if (standard_planted && flag)
-	{
-	  has_standard = true;
-	  player_standard_id = flag->getPlantableOriginalOwner()->getId();
-          has_bag = backpack->size () > 1;
-	}
-      else
-        {
-          has_bag = true;
-          bag_player_id = backpack->getOwnerId ();
-        }
-    }
-
-  Stack *stack = GameMap::getStrongestStack(tile);
-  if (stack)
-    {
-      if (viewing->getFogMap()->isCompletelyObscuredFogTile(tile) == false)
-	{
-	  //selected stack gets drawn in gamebigmap
-	  if (Playerlist::getActiveplayer()->getActivestack() != stack)
-	    {
-	      stack_player_id = stack->getOwner()->getId();
-	      Maptile *m = GameMap::getInstance()->getTile(tile);
-	      if (stack->getFortified() == true &&
-		  m->getBuilding() != Maptile::CITY &&
-		  m->getBuilding() != Maptile::RUIN &&
-		  m->getBuilding() != Maptile::TEMPLE)
-		has_tower = true;
-	      else if (stack->hasShip() == true)
-                {
-                  has_ship = true;
-                  stack_size = GameMap::getStacks(stack->getPos())->countNumberOfArmies(Playerlist::getInstance()->getPlayer(stack_player_id));
-                  if (stack_size > 0 && (guint)stack_size > MAX_STACK_SIZE)
-                    stack_size = stack->size();
-                  //here we show the number of armies on the tile.
-                  //instead of the number of armies in the stack.
-                  //so that stacks appear whole before we click on them.
-                  //and that a stack of 1 can't hide a stack of 7.
-                }
-	      else
-		{
-		  army_type_id = (*stack->begin())->getTypeId();
-                  stack_size = GameMap::getStacks(stack->getPos())->countNumberOfArmies(Playerlist::getInstance()->getPlayer(stack_player_id));
-                  if (stack_size > 0 && (guint)stack_size > MAX_STACK_SIZE)
-                    stack_size = stack->size();
-		}
-	    }
-	}
-    }
-
   if (building_type != Maptile::NONE)
     {
       switch (building_type)
@@ -595,21 +719,239 @@ void BigMap::draw_buffer_tile(Vector<int> tile, Cairo::RefPtr<Cairo::Surface> su
     }
   if (GameMap::getTileset()->getStone()->getName().empty() == true)
     stone_type = -1;
-  PixMask *pixmask = 
-    gc->getTilePic(tile_style_id, fog_type_id, has_bag, bag_player_id,
-                   has_standard, player_standard_id, stack_size,
-                   stack_player_id, army_type_id, has_tower, has_ship,
-                   building_type, building_subtype, building_tile,
-                   building_player_id, tilesize, d_grid_toggled, stone_type);
-  pixmask->blit(surface, tile_to_buffer_pos(tile));
+
+  terrain.tile_style_id = m->getTileStyleId();
+  terrain.building_type = building_type;
+  terrain.building_subtype = building_subtype;
+  terrain.building_tile = building_tile;
+  terrain.building_player_id = building_player_id;
+  terrain.stone_type = stone_type;
+}
+
+void BigMap::draw_buffer_tile(Vector<int> tile, Cairo::RefPtr<Cairo::Surface> surface)
+{
+  //the terrain is already there from the chunks.  this draws the things
+  //that go on top of it.
+  DrawStats::count(DrawStats::TILES_DRAWN);
+  guint32 tilesize = GameMap::getInstance()->getTileSize();
+  Player *viewing = Playerlist::getViewingplayer();
+  ImageCache *gc = ImageCache::getInstance();
+  int fog_type_id = 0;
+  if (d_no_fog)
+    fog_type_id = 0;
+  else if (Playerlist::getViewingplayer()->getType() != Player::HUMAN &&
+      GameScenarioOptions::s_hidden_map == true)
+    fog_type_id = FogMap::ALL;
+  else
+    fog_type_id = viewing->getFogMap()->getShadeTile(tile);
+
+  bool has_bag = false;
+  guint32 bag_player_id = 0;
+  bool has_standard = false;
+  guint32 player_standard_id = 0;
+  int stack_size = -1;
+  int stack_player_id = -1;
+  int army_type_id = -1;
+  bool has_ship = false;
+  bool has_tower = false;
+
+  if (fog_type_id == FogMap::ALL)
+    {
+      //short circuit.  the tile is completely fogged, and none of the
+      //terrain under it gets to show through.
+      PixMask *pixmask =
+	gc->getTilePic(-1, fog_type_id, has_bag, bag_player_id,
+                       has_standard, player_standard_id, stack_size,
+                       stack_player_id, army_type_id, has_tower, has_ship,
+                       Maptile::NONE, -1, Vector<int>(-1,-1), -1, tilesize,
+                       false, -1);
+      Vector<int> p = tile_to_buffer_pos(tile);
+      Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create(surface);
+      context->set_operator(Cairo::OPERATOR_CLEAR);
+      context->rectangle(p.x, p.y, tilesize, tilesize);
+      context->fill();
+      pixmask->blit(surface, p);
+      return;
+    }
+  MapBackpack *backpack = GameMap::getInstance()->getTile(tile)->getBackpack();
+  if (backpack && backpack->empty() == false)
+    {
+      bool standard_planted = false;
+      Item *flag = backpack->getFirstPlantedItem();
+      if (flag)
+	standard_planted = true;
+
+      if (standard_planted && flag)
+	{
+	  has_standard = true;
+	  player_standard_id = flag->getPlantableOriginalOwner()->getId();
+          has_bag = backpack->size () > 1;
+	}
+      else
+        {
+          has_bag = true;
+          bag_player_id = backpack->getOwnerId ();
+        }
+    }
+
+  Stack *stack = GameMap::getStrongestStack(tile);
+  if (stack)
+    {
+      if (d_no_fog ||
+          viewing->getFogMap()->isCompletelyObscuredFogTile(tile) == false)
+	{
+	  //selected stack gets drawn in gamebigmap
+	  if (Playerlist::getActiveplayer()->getActivestack() != stack)
+	    {
+	      stack_player_id = stack->getOwner()->getId();
+	      Maptile *m = GameMap::getInstance()->getTile(tile);
+	      if (stack->getFortified() == true &&
+		  m->getBuilding() != Maptile::CITY &&
+		  m->getBuilding() != Maptile::RUIN &&
+		  m->getBuilding() != Maptile::TEMPLE)
+		has_tower = true;
+	      else if (stack->hasShip() == true)
+                {
+                  has_ship = true;
+                  stack_size = GameMap::getStacks(stack->getPos())->countNumberOfArmies(Playerlist::getInstance()->getPlayer(stack_player_id));
+                  if (stack_size > 0 && (guint)stack_size > MAX_STACK_SIZE)
+                    stack_size = stack->size();
+                  //here we show the number of armies on the tile.
+                  //instead of the number of armies in the stack.
+                  //so that stacks appear whole before we click on them.
+                  //and that a stack of 1 can't hide a stack of 7.
+                }
+	      else
+		{
+		  army_type_id = (*stack->begin())->getTypeId();
+                  stack_size = GameMap::getStacks(stack->getPos())->countNumberOfArmies(Playerlist::getInstance()->getPlayer(stack_player_id));
+                  if (stack_size > 0 && (guint)stack_size > MAX_STACK_SIZE)
+                    stack_size = stack->size();
+		}
+	    }
+	}
+    }
+
+  if (fog_type_id != 0 || has_bag || has_standard || stack_player_id > -1 ||
+      d_grid_toggled)
+    {
+      PixMask *pixmask = 
+        gc->getTilePic(-1, fog_type_id, has_bag, bag_player_id,
+                       has_standard, player_standard_id, stack_size,
+                       stack_player_id, army_type_id, has_tower, has_ship,
+                       Maptile::NONE, -1, Vector<int>(-1,-1), -1, tilesize,
+                       d_grid_toggled, -1);
+      pixmask->blit(surface, tile_to_buffer_pos(tile));
+    }
+}
+
+BigMap::TerrainChunk &BigMap::get_chunk(Vector<int> chunk_pos, guint32 tilesize)
+{
+  guint64 key = (guint64(tilesize) << 32) |
+    (guint64(chunk_pos.y & 0xffff) << 16) | guint64(chunk_pos.x & 0xffff);
+  d_chunk_clock++;
+  std::map<guint64, TerrainChunk>::iterator it = d_chunks.find(key);
+  if (it != d_chunks.end())
+    {
+      (*it).second.last_used = d_chunk_clock;
+      return (*it).second;
+    }
+
+  // keep enough chunks to cover the buffer a couple of times over, and
+  // throw out the one that was used the longest time ago.
+  size_t max_chunks =
+    2 * ((buffer_view.w + CHUNK_SIZE - 1) / CHUNK_SIZE + 1) *
+    ((buffer_view.h + CHUNK_SIZE - 1) / CHUNK_SIZE + 1);
+  if (d_chunks.size() >= max_chunks)
+    {
+      std::map<guint64, TerrainChunk>::iterator oldest = d_chunks.begin();
+      for (it = d_chunks.begin(); it != d_chunks.end(); ++it)
+        if ((*it).second.last_used < (*oldest).second.last_used)
+          oldest = it;
+      d_chunks.erase(oldest);
+    }
+
+  TerrainChunk &chunk = d_chunks[key];
+  chunk.surface = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, CHUNK_SIZE * tilesize, CHUNK_SIZE * tilesize);
+  DrawStats::count(DrawStats::SURFACES_ALLOCATED);
+  TerrainTile blank;
+  blank.tile_style_id = -1;
+  blank.building_type = Maptile::NONE;
+  blank.building_subtype = -1;
+  blank.building_tile = Vector<int>(-1,-1);
+  blank.building_player_id = -1;
+  blank.stone_type = -1;
+  chunk.tiles.assign(CHUNK_SIZE * CHUNK_SIZE, blank);
+  chunk.dirty = true;
+  chunk.last_used = d_chunk_clock;
+  return chunk;
+}
+
+void BigMap::update_chunk(Vector<int> chunk_pos, TerrainChunk &chunk)
+{
+  // only the tiles whose terrain or building has changed get drawn again.
+  guint32 tilesize = GameMap::getInstance()->getTileSize();
+  Vector<int> origin = chunk_pos * CHUNK_SIZE;
+  for (int j = 0; j < CHUNK_SIZE; j++)
+    for (int i = 0; i < CHUNK_SIZE; i++)
+      {
+        Vector<int> tile = origin + Vector<int>(i, j);
+        if (tile.x >= GameMap::getWidth() || tile.y >= GameMap::getHeight())
+          continue;
+        TerrainTile terrain;
+        get_terrain(tile, terrain);
+        TerrainTile &drawn = chunk.tiles[j * CHUNK_SIZE + i];
+        if (drawn == terrain)
+          continue;
+        PixMask *pixmask =
+          ImageCache::getInstance()->getTilePic
+          (terrain.tile_style_id, 0, false, 0, false, 0, -1, -1, -1, false,
+           false, Maptile::Building(terrain.building_type),
+           terrain.building_subtype, terrain.building_tile,
+           terrain.building_player_id, tilesize, false, terrain.stone_type);
+        pixmask->blit(chunk.surface, Vector<int>(i, j) * tilesize);
+        drawn = terrain;
+      }
+  chunk.dirty = false;
+}
+
+void BigMap::draw_terrain(const LwRectangle &tiles, Cairo::RefPtr<Cairo::Surface> surface)
+{
+  // the chunks are painted whole, or as much of them as is in view.
+  guint32 tilesize = GameMap::getInstance()->getTileSize();
+  Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create(surface);
+  context->set_operator(Cairo::OPERATOR_SOURCE);
+  Vector<int> first = tiles.pos / CHUNK_SIZE;
+  Vector<int> last = (tiles.pos + tiles.dim - Vector<int>(1, 1)) / CHUNK_SIZE;
+  for (int y = first.y; y <= last.y; y++)
+    for (int x = first.x; x <= last.x; x++)
+      {
+        Vector<int> chunk_pos(x, y);
+        TerrainChunk &chunk = get_chunk(chunk_pos, tilesize);
+        if (chunk.dirty)
+          update_chunk(chunk_pos, chunk);
+        LwRectangle part =
+          intersect(tiles, LwRectangle(x * CHUNK_SIZE, y * CHUNK_SIZE,
+                                       CHUNK_SIZE, CHUNK_SIZE));
+        Vector<int> p = tile_to_buffer_pos(chunk_pos * CHUNK_SIZE);
+        Vector<int> q = tile_to_buffer_pos(part.pos);
+        context->set_source(chunk.surface, p.x, p.y);
+        context->rectangle(q.x, q.y, part.w * tilesize, part.h * tilesize);
+        context->fill();
+      }
 }
 
 void BigMap::draw_buffer_tiles(const LwRectangle &map_view, Cairo::RefPtr<Cairo::Surface> surface)
 {
-  for (int i = map_view.x; i < map_view.x + map_view.w; i++)
-    for (int j = map_view.y; j < map_view.y + map_view.h; j++)
-      if (i < GameMap::getWidth() && j < GameMap::getHeight())
-	draw_buffer_tile(Vector<int>(i,j), surface);
+  LwRectangle tiles =
+    intersect(map_view, LwRectangle(0, 0, GameMap::getWidth(),
+                                    GameMap::getHeight()));
+  if (tiles.w <= 0 || tiles.h <= 0)
+    return;
+  draw_terrain(tiles, surface);
+  for (int i = tiles.x; i < tiles.x + tiles.w; i++)
+    for (int j = tiles.y; j < tiles.y + tiles.h; j++)
+      draw_buffer_tile(Vector<int>(i,j), surface);
 }
 
 void BigMap::draw_buffer(const LwRectangle &map_view, Cairo::RefPtr<Cairo::Surface> surface)
@@ -620,6 +962,7 @@ void BigMap::draw_buffer(const LwRectangle &map_view, Cairo::RefPtr<Cairo::Surfa
 void BigMap::toggle_grid()
 {
   d_grid_toggled = !d_grid_toggled;
+  mark_all_dirty();
   draw(true);
 }
 
@@ -25,6 +25,9 @@
 #ifndef BIGMAP_H
 #define BIGMAP_H
 
+#include <list>
+#include <map>
+#include <vector>
 #include <sigc++/signal.h>
 #include <sigc++/trackable.h>
 #include <sigc++/connection.h>
@@ -50,6 +53,16 @@ class Location;
   * Draws everything to a buffer to simplify scrolling, the buffer is then
   * blitted to the screen. The current view of the map is kept track of both
   * approximately (in tiles) and more precisely in pixels.
+  *
+  * The map tiles are kept in a separate surface from one draw to the next,
+  * and only the tiles that have been marked as dirty get drawn again.  The
+  * game marks tiles dirty when stacks move and when the fog changes.
+  *
+  * The terrain and buildings don't often change, so they are kept in
+  * chunks of tiles for each zoom level.  The chunks are painted into the
+  * map tiles whole, and the stacks, bags, grid and fog are drawn on top of
+  * them.  Marking tiles dirty only draws these again, while marking
+  * everything dirty also makes the chunks check their terrain.
   */
 class BigMap: public sigc::trackable
 {
@@ -62,6 +75,17 @@ class BigMap: public sigc::trackable
     // draw everything
     void draw(bool redraw_buffer = true);
 
+    //! Make the given tiles get drawn again the next time we draw.
+    void mark_dirty(LwRectangle tiles);
+    void mark_dirty(Vector<int> tile) {mark_dirty(LwRectangle(tile));}
+
+    //! Make every tile get drawn again the next time we draw.
+    /**
+     * The terrain and buildings get looked at again too, for when they
+     * might have changed.
+     */
+    void mark_all_dirty();
+
     bool get_toggled () const {return d_grid_toggled;}
     LwRectangle get_view () const {return view;} // in tiles
 
@@ -89,8 +113,20 @@ class BigMap: public sigc::trackable
     //draw a fight graphic, or not
     void setFighting(LocationBox ruckus) {d_fighting = ruckus;};
 
-    //! Save the whole map as one big image (bmp file).
-    bool saveAsBitmap(Glib::ustring filename);
+    //! Save the whole map as one big image (png file).
+    /**
+     * The map is drawn and written out a band of tiles at a time, so big
+     * maps don't have to fit into memory all at once.
+     *
+     * @param scale  How big the image is compared to the map, e.g. 0.25
+     *               for a thumbnail a quarter of the size.
+     * @param fog    Whether to draw the fog of the viewing player.  Without
+     *               it, the whole map is shown along with every stack.
+     *
+     * @return false if the file couldn't be written.
+     */
+    bool saveAsBitmap(Glib::ustring filename, double scale = 1.0,
+                      bool fog = true);
 
     void toggle_grid();
     bool scroll(GdkEventScroll *event);
@@ -118,10 +154,16 @@ class BigMap: public sigc::trackable
     bool blank_screen;
 
     bool d_grid_toggled;
+    bool d_no_fog; // saveAsBitmap is drawing the map without the fog
     Gtk::Allocation image;
     double deltax; //for smooth scrolling
     double deltay;
 
+    Cairo::RefPtr<Cairo::Surface> d_tiles; // the map tiles without overlays
+    LwRectangle d_tiles_view;	// the part of the map in d_tiles, in tiles
+    std::list<LwRectangle> d_dirty; // tiles that need drawing, in tiles
+    bool d_all_dirty;
+
     // helpers
     Vector<int> mouse_pos_to_tile(Vector<int> pos);
     Vector<int> tile_to_buffer_pos(Vector<int> tile);
@@ -137,8 +179,68 @@ class BigMap: public sigc::trackable
     void draw_buffer(const LwRectangle &map_view, Cairo::RefPtr<Cairo::Surface> surface);
     void draw_buffer_tiles(const LwRectangle &map_view, Cairo::RefPtr<Cairo::Surface> surface);
 
+    //! Draw the things that go on top of the terrain of a tile.
     void draw_buffer_tile(Vector<int> tile, Cairo::RefPtr<Cairo::Surface> surface);
+
+    //! The terrain and building that a tile of a chunk was drawn with.
+    struct TerrainTile
+    {
+      int tile_style_id;
+      int building_type;
+      int building_subtype;
+      Vector<int> building_tile;
+      int building_player_id;
+      int stone_type;
+      bool operator==(const TerrainTile &t) const
+        {
+          return tile_style_id == t.tile_style_id &&
+            building_type == t.building_type &&
+            building_subtype == t.building_subtype &&
+            building_tile == t.building_tile &&
+            building_player_id == t.building_player_id &&
+            stone_type == t.stone_type;
+        }
+      bool operator!=(const TerrainTile &t) const {return !(*this == t);}
+    };
+
+    //! A square of tiles showing just the terrain and the buildings.
+    /**
+     * A dirty chunk looks at the terrain of its tiles before it gets
+     * painted, and draws again the tiles where it has changed.
+     */
+    struct TerrainChunk
+    {
+      Cairo::RefPtr<Cairo::Surface> surface;
+      std::vector<TerrainTile> tiles;
+      bool dirty;
+      guint32 last_used;
+    };
+
+    //! How many tiles wide and high a TerrainChunk is.
+    static const int CHUNK_SIZE = 16;
+
+    void get_terrain(Vector<int> tile, TerrainTile &terrain);
+    void draw_terrain(const LwRectangle &tiles, Cairo::RefPtr<Cairo::Surface> surface);
+    TerrainChunk &get_chunk(Vector<int> chunk_pos, guint32 tilesize);
+    void update_chunk(Vector<int> chunk_pos, TerrainChunk &chunk);
+    void update_tiles();
+    void scroll_tiles();
+    void check_for_changes();
     void clip_viewable_buffer(Cairo::RefPtr<Cairo::Surface> pixmap, Vector<int> pos, Cairo::RefPtr<Cairo::Surface> out);
+
+    // what the tiles depended on when we last drew them
+    guint32 d_drawn_tilesize;
+    guint32 d_drawn_viewer_id;
+    guint32 d_drawn_active_player_id;
+    guint32 d_drawn_active_stack_id;
+    Vector<int> d_drawn_active_stack_pos;
+    guint32 d_drawn_tileset_id;
+    guint32 d_drawn_cityset_id;
+    guint32 d_drawn_shieldset_id;
+
+    // the chunks we've drawn, keyed by tile size and position
+    std::map<guint64, TerrainChunk> d_chunks;
+    guint32 d_chunk_clock;
 };
 
 #endif
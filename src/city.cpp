@@ -50,7 +50,8 @@ City::City(Vector<int> pos, guint32 width, Glib::ustring name, guint32 gold,
     :OwnerId((Player *)0), NamedLocation(pos, width, name, ""),
     ProdSlotlist(numslots), d_gold(gold), d_defense_level(1), d_burnt(false), 
     d_vectoring(false), d_vector(Vector<int>(-1,-1)), 
-    d_capital(false), d_capital_owner(0), d_build_production (true)
+    d_capital(false), d_capital_owner(0), d_build_production (true),
+    d_stacks_known(false)
 
 {
   // set the tiles to city type
@@ -64,7 +65,7 @@ City::City(Vector<int> pos, guint32 width, Glib::ustring name, guint32 gold,
 
 City::City(XML_Helper* helper, guint32 width)
     :OwnerId(helper), NamedLocation(helper, width),
-    ProdSlotlist(helper)
+    ProdSlotlist(helper), d_stacks_known(false)
 {
     //initialize the city
 
@@ -108,7 +109,8 @@ City::City(const City& c, bool sync_id)
     :OwnerId(c), NamedLocation(c, sync_id), ProdSlotlist(c),
     d_gold(c.d_gold), d_defense_level(c.d_defense_level), d_burnt(c.d_burnt),
     d_vectoring(c.d_vectoring),d_vector(c.d_vector), d_capital(c.d_capital), 
-    d_capital_owner(c.d_capital_owner), d_build_production(c.d_build_production)
+    d_capital_owner(c.d_capital_owner), d_build_production(c.d_build_production),
+    d_stacks_known(false)
 {
 }
 
@@ -116,7 +118,8 @@ City::City(const City& c, Vector<int> pos)
     :OwnerId(c), NamedLocation(c, pos), ProdSlotlist(c),
     d_gold(c.d_gold), d_defense_level(c.d_defense_level), d_burnt(c.d_burnt),
     d_vectoring(c.d_vectoring),d_vector(c.d_vector), d_capital(c.d_capital), 
-    d_capital_owner(c.d_capital_owner), d_build_production(c.d_build_production)
+    d_capital_owner(c.d_capital_owner), d_build_production(c.d_build_production),
+    d_stacks_known(false)
 {
 }
 
@@ -358,6 +361,42 @@ std::vector<Stack *> City::getDefenders() const
   return getOwner()->getStacklist()->getDefendersInCity(this);
 }
 
+const std::list<StackTileRecord> &City::getStacksOnTiles() const
+{
+  if (d_stacks_known == false)
+    {
+      d_stacks.clear();
+      for (unsigned int i = 0; i < getSize(); i++)
+        for (unsigned int j = 0; j < getSize(); j++)
+          {
+            StackTile *stile = GameMap::getStacks(getPos() + Vector<int>(i,j));
+            d_stacks.insert(d_stacks.end(), stile->begin(), stile->end());
+          }
+      d_stacks_known = true;
+    }
+  return d_stacks;
+}
+
+void City::stackArrives(const StackTileRecord &rec)
+{
+  if (d_stacks_known)
+    d_stacks.push_back(rec);
+}
+
+void City::stackLeaves(guint32 stack_id)
+{
+  if (d_stacks_known == false)
+    return;
+  for (std::list<StackTileRecord>::iterator it = d_stacks.begin();
+       it != d_stacks.end();)
+    {
+      if ((*it).stack_id == stack_id)
+        it = d_stacks.erase(it);
+      else
+        ++it;
+    }
+}
+
 guint32 City::countDefenders() const
 {
   std::vector<Stack*> defenders;
@@ -30,6 +30,7 @@
 #include "OwnerId.h"
 #include "Renamable.h"
 #include "prodslotlist.h"
+#include "stacktile.h"
 
 class Player;
 class Stack;
@@ -259,6 +260,23 @@ class City : public OwnerId, public NamedLocation, public ProdSlotlist
 	//! Return the stacks that are inside the city walls.
 	std::vector<Stack *> getDefenders() const;
 
+	//! Return the stacks of any player that are on the city's tiles.
+	/**
+	 * The records are kept up to date by the StackTile objects of the
+	 * city's tiles as stacks arrive and leave.  They are looked up from
+	 * the game map the first time they are needed.
+	 */
+	const std::list<StackTileRecord> &getStacksOnTiles() const;
+
+	//! Remember that a stack has arrived on one of the city's tiles.
+	void stackArrives(const StackTileRecord &rec);
+
+	//! Remember that a stack has left one of the city's tiles.
+	void stackLeaves(guint32 stack_id);
+
+	//! Forget the stacks on the city's tiles, they are looked up again.
+	void forgetStacksOnTiles() {d_stacks_known = false;}
+
 	// Static Methods
 	
 	//! Get the default name of any city.
@@ -358,6 +376,12 @@ class City : public OwnerId, public NamedLocation, public ProdSlotlist
          *
          */
         bool d_build_production;
+
+	//! The stacks on the city's tiles, as given to us by the StackTiles.
+	mutable std::list<StackTileRecord> d_stacks;
+
+	//! Whether or not d_stacks has been looked up from the game map.
+	mutable bool d_stacks_known;
 };
 
 bool armyCompareStrength (const ArmyProdBase *lhs, const ArmyProdBase *rhs);
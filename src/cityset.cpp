@@ -222,6 +222,7 @@ void Cityset::uninstantiateImages()
 {
   for (auto i : getImages ())
     i->uninstantiateImages ();
+  setInstantiated (false);
 }
 
 void Cityset::instantiateImages(bool scale, bool &broken)
@@ -270,6 +271,7 @@ void Cityset::instantiateImages(bool scale, bool &broken)
     d_rcity->instantiateImages ();
 
   t.Close();
+  setInstantiated (true);
 }
 
 bool Cityset::validate()
@@ -63,19 +63,6 @@ Citysetlist::~Citysetlist()
   clear();
 }
 
-void Citysetlist::instantiateImages(bool &broken)
-{
-  broken = false;
-  for (iterator it = begin(); it != end(); ++it)
-    {
-      if (!broken)
-        {
-          if ((*it)->validate () == true)
-            (*it)->instantiateImages(true, broken);
-        }
-    }
-}
-
 void Citysetlist::uninstantiateImages()
 {
   for (iterator it = begin(); it != end(); ++it)
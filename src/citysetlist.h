@@ -45,7 +45,6 @@ class Citysetlist : public SetList<Cityset>, public sigc::trackable
         //! Explicitly delete the singleton instance of this class.
         static void deleteInstance();
 
-	void instantiateImages(bool &broken);
 	void uninstantiateImages();
 
     private:
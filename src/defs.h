@@ -31,7 +31,7 @@
 #include <glibmm.h>
 #include <libintl.h>
 
-#define LORDSAWAR_SAVEGAME_VERSION "0.3.3"
+#define LORDSAWAR_SAVEGAME_VERSION "0.3.4"
 #define LORDSAWAR_TILESET_VERSION "0.3.3"
 #define LORDSAWAR_ARMYSET_VERSION "0.3.3"
 #define LORDSAWAR_CITYSET_VERSION "0.2.1"
@@ -43,6 +43,7 @@
 #define LORDSAWAR_PROFILES_VERSION "0.3.0"
 #define LORDSAWAR_RECENTLY_HOSTED_VERSION "0.3.0"
 #define LORDSAWAR_PBM_TURN_VERSION "0.3.0"
+#define LORDSAWAR_SCENARIO_CACHE_VERSION "0.3.3"
 #define _(string) Glib::locale_to_utf8(Glib::ustring(gettext(string))) // Macro for the gettext
 #define N_(string) string
 
@@ -118,6 +119,7 @@ const Glib::ustring SHIELDSET_EXT = ".lws";
 const Glib::ustring MAP_EXT = ".map";
 const Glib::ustring SAVE_EXT = ".sav";
 const Glib::ustring PBM_EXT = ".trn";
+const Glib::ustring JOURNAL_EXT = ".journal";
 const Glib::ustring RECENTLY_PLAYED_LIST = "recently-played.xml";
 const Glib::ustring RECENTLY_EDITED_LIST = "recently-edited.xml";
 const Glib::ustring PROFILE_LIST = "profiles.xml";
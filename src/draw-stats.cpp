@@ -0,0 +1,171 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#include <iomanip>
+#include "draw-stats.h"
+#include "timing.h"
+
+static const char *section_names[DrawStats::NUM_SECTIONS] =
+{
+  "bigmap_draw",
+  "overviewmap_draw",
+  "smallmap_slide_view",
+  "gamebigmap_after_draw",
+};
+
+static const char *counter_names[DrawStats::NUM_COUNTERS] =
+{
+  "tiles_drawn",
+  "overview_pixels_drawn",
+  "image_cache_hits",
+  "image_cache_misses",
+  "surfaces_allocated",
+};
+
+DrawStats* DrawStats::s_instance = 0;
+bool DrawStats::s_enabled = false;
+guint64 DrawStats::s_counters[NUM_COUNTERS];
+
+DrawStats* DrawStats::getInstance()
+{
+  if (!s_instance)
+    s_instance = new DrawStats();
+
+  return s_instance;
+}
+
+void DrawStats::deleteInstance()
+{
+  if (!s_instance)
+    return;
+
+  delete s_instance;
+  s_instance = NULL;
+}
+
+DrawStats::DrawStats()
+ : d_json(false), d_started(0), d_last_flush(0)
+{
+  clear();
+}
+
+DrawStats::~DrawStats()
+{
+  if (s_enabled)
+    {
+      d_timer.disconnect();
+      flush();
+      s_enabled = false;
+    }
+}
+
+bool DrawStats::start(Glib::ustring filename, guint32 msecs_interval)
+{
+  d_out.open(filename.c_str(), std::ios::out | std::ios::trunc);
+  if (!d_out)
+    return false;
+  Glib::ustring lower = filename.lowercase();
+  d_json = lower.size() > 5 && lower.substr(lower.size() - 5) == ".json";
+  d_out << std::fixed << std::setprecision(3);
+  if (!d_json)
+    writeCsvHeader();
+  clear();
+  d_started = g_get_monotonic_time();
+  d_last_flush = d_started;
+  s_enabled = true;
+  d_timer =
+    Timing::instance().register_timer
+    (sigc::mem_fun(*this, &DrawStats::flush), msecs_interval);
+  return true;
+}
+
+void DrawStats::clear()
+{
+  for (guint32 i = 0; i < NUM_SECTIONS; i++)
+    {
+      d_timings[i].calls = 0;
+      d_timings[i].total = 0;
+      d_timings[i].max = 0;
+    }
+  for (guint32 i = 0; i < NUM_COUNTERS; i++)
+    s_counters[i] = 0;
+}
+
+void DrawStats::addTime(Section s, gint64 usecs)
+{
+  d_timings[s].calls++;
+  d_timings[s].total += usecs;
+  if (usecs > d_timings[s].max)
+    d_timings[s].max = usecs;
+}
+
+bool DrawStats::flush()
+{
+  if (!s_enabled)
+    return Timing::STOP;
+  gint64 now = g_get_monotonic_time();
+  double seconds = (now - d_started) / 1000000.0;
+  double period = (now - d_last_flush) / 1000000.0;
+  if (d_json)
+    writeJson(seconds, period);
+  else
+    writeCsv(seconds, period);
+  d_out.flush();
+  d_last_flush = now;
+  clear();
+  return Timing::CONTINUE;
+}
+
+void DrawStats::writeCsvHeader()
+{
+  d_out << "seconds,period";
+  for (guint32 i = 0; i < NUM_SECTIONS; i++)
+    d_out << "," << section_names[i] << "_calls"
+      << "," << section_names[i] << "_ms"
+      << "," << section_names[i] << "_max_ms";
+  for (guint32 i = 0; i < NUM_COUNTERS; i++)
+    d_out << "," << counter_names[i];
+  d_out << std::endl;
+}
+
+void DrawStats::writeCsv(double seconds, double period)
+{
+  d_out << seconds << "," << period;
+  for (guint32 i = 0; i < NUM_SECTIONS; i++)
+    d_out << "," << d_timings[i].calls
+      << "," << d_timings[i].total / 1000.0
+      << "," << d_timings[i].max / 1000.0;
+  for (guint32 i = 0; i < NUM_COUNTERS; i++)
+    d_out << "," << s_counters[i];
+  d_out << std::endl;
+}
+
+void DrawStats::writeJson(double seconds, double period)
+{
+  d_out << "{\"seconds\": " << seconds << ", \"period\": " << period;
+  d_out << ", \"sections\": {";
+  for (guint32 i = 0; i < NUM_SECTIONS; i++)
+    d_out << (i ? ", " : "") << "\"" << section_names[i] << "\": {"
+      << "\"calls\": " << d_timings[i].calls
+      << ", \"ms\": " << d_timings[i].total / 1000.0
+      << ", \"max_ms\": " << d_timings[i].max / 1000.0 << "}";
+  d_out << "}, \"counters\": {";
+  for (guint32 i = 0; i < NUM_COUNTERS; i++)
+    d_out << (i ? ", " : "") << "\"" << counter_names[i] << "\": "
+      << s_counters[i];
+  d_out << "}}" << std::endl;
+}
@@ -0,0 +1,139 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#pragma once
+#ifndef DRAW_STATS_H
+#define DRAW_STATS_H
+
+#include <fstream>
+#include <glibmm.h>
+
+//! Measures how long the maps take to draw, and how much work they do.
+/**
+ * This is turned on with the --draw-stats command-line option.  Every few
+ * seconds a record of the time spent in each section of drawing code, and
+ * of the counters, is added to a file.  The file is written as JSON, one
+ * object per line, when its name ends in .json, and as CSV otherwise.
+ *
+ * When it isn't turned on, the timers and counters cost one test of a
+ * boolean.
+ */
+class DrawStats
+{
+ public:
+    //! The sections of code that get timed.
+    enum Section
+      {
+        BIGMAP_DRAW = 0,
+        OVERVIEWMAP_DRAW,
+        SMALLMAP_SLIDE_VIEW,
+        GAMEBIGMAP_AFTER_DRAW,
+        NUM_SECTIONS
+      };
+
+    //! The things that get counted.
+    enum Counter
+      {
+        //! Big map tiles drawn into the buffer.
+        TILES_DRAWN = 0,
+        //! Pixels of terrain drawn on the overview maps.
+        OVERVIEW_PIXELS_DRAWN,
+        //! Images that were already in the image cache.
+        IMAGE_CACHE_HITS,
+        //! Images that the image cache had to make.
+        IMAGE_CACHE_MISSES,
+        //! Cairo surfaces made for the map buffers, chunks and overview maps.
+        SURFACES_ALLOCATED,
+        NUM_COUNTERS
+      };
+
+    //! Times a section of code, from when it is made until it goes away.
+    class Timer
+    {
+     public:
+        Timer(Section s)
+          : d_section(s), d_start(s_enabled ? g_get_monotonic_time() : -1) {}
+        ~Timer()
+          {
+            if (d_start >= 0)
+              getInstance()->addTime(d_section,
+                                     g_get_monotonic_time() - d_start);
+          }
+     private:
+        Section d_section;
+        gint64 d_start;
+    };
+
+    //! Returns the singleton instance.  Creates a new one if needed.
+    static DrawStats *getInstance();
+
+    //! Explicitly deletes the singleton instance, writing out the last record.
+    static void deleteInstance();
+
+    //! Whether or not the timers and counters are doing anything.
+    static bool isEnabled() {return s_enabled;}
+
+    //! Add to one of the counters.
+    static void count(Counter c, guint32 n = 1)
+      {
+        if (s_enabled)
+          s_counters[c] += n;
+      }
+
+    //! Start writing records to the given file every so often.
+    /**
+     * @return false if the file couldn't be opened.
+     */
+    bool start(Glib::ustring filename, guint32 msecs_interval);
+
+    //! Add the time a section took, in microseconds.
+    void addTime(Section s, gint64 usecs);
+
+    //! Write out a record of what happened since the last one.
+    bool flush();
+
+ protected:
+    DrawStats();
+    ~DrawStats();
+
+ private:
+    void writeCsvHeader();
+    void writeCsv(double seconds, double period);
+    void writeJson(double seconds, double period);
+    void clear();
+
+    //! How long each section took in total, and at most, in microseconds.
+    struct SectionTime
+    {
+      guint64 calls;
+      gint64 total;
+      gint64 max;
+    };
+
+    static DrawStats *s_instance;
+    static bool s_enabled;
+    static guint64 s_counters[NUM_COUNTERS];
+
+    std::ofstream d_out;
+    bool d_json;
+    gint64 d_started;
+    gint64 d_last_flush;
+    SectionTime d_timings[NUM_SECTIONS];
+    sigc::connection d_timer;
+};
+
+#endif // DRAW_STATS_H
@@ -631,6 +631,10 @@ bool FileCompat::xsl_transform(Glib::ustring filename, Glib::ustring xsl_file) c
   xsltStylesheetPtr cur = NULL;
   xmlDocPtr doc, res;
 
+  // the stylesheets only understand the xml form.
+  if (XML_Helper::convertFile(filename, false) == false)
+    return false;
+
   xmlChar *xsl = xmlCharStrdup(xsl_file.c_str());
   cur = xsltParseStylesheetFile(xsl);
   if (cur == NULL)
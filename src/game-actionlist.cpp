@@ -75,14 +75,16 @@ GameActionlist::GameActionlist(XML_Helper* helper)
   helper->registerTag(TurnActionlist::d_tag, sigc::mem_fun(this, &GameActionlist::load));
 }
 
-bool GameActionlist::save(XML_Helper* helper) const
+bool GameActionlist::save(XML_Helper* helper, guint32 skip) const
 {
     bool retval = true;
 
     retval &= helper->openTag(GameActionlist::d_tag);
 
+    guint32 i = 0;
     for (GameActionlist::const_iterator it = begin(); it != end(); ++it)
-      retval &= (*it)->save(helper);
+      if (i++ >= skip)
+        retval &= (*it)->save(helper);
     
     retval &= helper->closeTag();
 
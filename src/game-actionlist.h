@@ -51,7 +51,12 @@ class GameActionlist : public std::list<TurnActionlist*>, public sigc::trackable
 	// Methods that operate on the class data but do not modify the class.
 
         //! Save the list of NetworkAction objects to a saved-game file.
-        bool save(XML_Helper* helper) const;
+        /**
+         * @param helper     The opened saved-game file to write to.
+         * @param skip       How many turns at the front to leave out,
+         *                   because they are kept in a RoundJournal.
+         */
+        bool save(XML_Helper* helper, guint32 skip = 0) const;
 
 	// Static Methods
 
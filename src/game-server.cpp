@@ -845,7 +845,7 @@ void GameServer::sendMap(Participant *part)
   File::erase(tmpfile);
   tmpfile += SAVE_EXT;
 
-  d_game_scenario->saveGame(tmpfile);
+  d_game_scenario->saveGame(tmpfile, SAVE_EXT, true);
 
   std::cerr << "sending map" << std::endl;
   network_server->sendFile(part->conn, MESSAGE_TYPE_SENDING_MAP, tmpfile);
@@ -180,6 +180,12 @@ void Game::addPlayer(Player *p)
   connections[p->getId()].push_back
     (p->getStacklist()->sstackDied.connect
      (sigc::mem_fun(this, &Game::on_stack_died)));
+  connections[p->getId()].push_back
+    (p->acting.connect
+     (sigc::hide(sigc::mem_fun(this, &Game::on_player_acted))));
+  connections[p->getId()].push_back
+    (p->getFogMap()->shades_changed.connect
+     (sigc::bind(sigc::mem_fun(this, &Game::on_fog_changed), p)));
   connections[p->getId()].push_back
     (p->aborted_turn.connect (sigc::mem_fun
 	   (game_stopped, &sigc::signal<void>::emit)));
@@ -1373,12 +1379,14 @@ void Game::stack_arrives_on_tile(Stack *stack, Vector<int> tile)
 {
   StackTile *stile = GameMap::getInstance()->getTile(tile)->getStacks();
   stile->arriving(stack);
+  bigmap->mark_dirty(tile);
 }
 
 void Game::stack_leaves_tile(Stack *stack, Vector<int> tile)
 {
   StackTile *stile = GameMap::getInstance()->getTile(tile)->getStacks();
   bool left = stile->leaving(stack);
+  bigmap->mark_dirty(tile);
   if (left == false)
     {
       if (stack == NULL)
@@ -1446,3 +1454,18 @@ void Game::on_stack_died ()
 {
   redraw ();
 }
+
+void Game::on_player_acted (Action *action)
+{
+  //stacks moving around are taken care of in stack_arrives_on_tile and
+  //stack_leaves_tile.  anything else a player does can change how the
+  //map looks in ways that are hard to pin down, so draw it all again.
+  if (action->getType() != Action::STACK_MOVE)
+    bigmap->mark_all_dirty();
+}
+
+void Game::on_fog_changed (LwRectangle tiles, Player *player)
+{
+  if (player == Playerlist::getViewingplayer())
+    bigmap->mark_dirty(tiles);
+}
@@ -28,6 +28,7 @@
 
 #include "sidebar-stats.h"
 #include "map-tip-position.h"
+#include "rectangle.h"
 #include "callback-enums.h"
 #include "army.h"
 #include "fight.h"
@@ -50,6 +51,7 @@ class Quest;
 class Reward;
 class StackTile;
 class Sage;
+class Action;
 
 //! Connects the various game classes with the GameWindow through signals.
 /** Controls a game.
@@ -258,6 +260,8 @@ class Game
 
     void on_bag_dropped ();
     void on_stack_died ();
+    void on_player_acted (Action *action);
+    void on_fog_changed (LwRectangle tiles, Player *player);
 
     GameScenario* d_gameScenario;
     NextTurn* d_nextTurn;
@@ -46,6 +46,7 @@
 #include "TarFileMaskedImage.h"
 
 #include "timing.h"
+#include "draw-stats.h"
 
 
 #include <iostream>
@@ -881,6 +882,7 @@ void GameBigMap::get_selector_frame_limits (Player *p, int &limitbig, int &limit
 
 void GameBigMap::after_draw()
 {
+  DrawStats::Timer timer(DrawStats::GAMEBIGMAP_AFTER_DRAW);
   if (blank_screen == true)
     return;
   ImageCache *gc = ImageCache::getInstance();
@@ -925,11 +927,9 @@ void GameBigMap::after_draw()
 	  Path::iterator it = stack->getPath()->end();
 	  --it;
 	  //this is where the ghosted army unit picture goes.
-	  PixMask *armypic = gc->getArmyPic(*stack->begin(), true)->copy();
-          armypic->scale (armypic, tilesize, tilesize);
 	  pos = tile_to_buffer_pos(*it);
-	  armypic->blit_centered(buffer, pos + (Vector<int>(tilesize,tilesize)/2));
-          delete armypic;
+	  gc->getArmyPic(*stack->begin(), true)->blit_scaled(buffer, pos,
+                                                             tilesize, tilesize);
 	}
     }
 
@@ -983,11 +983,10 @@ void GameBigMap::after_draw()
           Playerlist::getActiveplayer()->getType() == Player::HUMAN)
         {
           //this is where the ghosted army unit picture goes.
-          PixMask *armypic = gc->getArmyPic(*stack->begin(), true)->copy();
-          armypic->scale (armypic, tilesize, tilesize);
           Vector<int> pos = tile_to_buffer_pos(current_tile);
-          armypic->blit_centered(buffer, pos + (Vector<int>(tilesize,tilesize)/2));
-          delete armypic;
+          gc->getArmyPic(*stack->begin(), true)->blit_scaled(buffer, pos,
+                                                             tilesize,
+                                                             tilesize);
           static Vector<int> prev_current_tile;
           if (current_tile != prev_current_tile)
             {
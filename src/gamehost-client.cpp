@@ -248,7 +248,7 @@ void GamehostClient::send_map(GameScenario *game_scenario)
 {
   Glib::ustring tmpfile = File::get_tmp_file();
   tmpfile += SAVE_EXT;
-  game_scenario->saveGame(tmpfile);
+  game_scenario->saveGame(tmpfile, SAVE_EXT, true);
   send_map_file(tmpfile);
   File::erase(tmpfile);
 }
@@ -564,6 +564,8 @@ GameScenario *Driver::create_new_scenario(GameParameters &g, GameScenario::PlayM
       Playerlist::getInstance()->syncPlayers(g.players);
       game_scenario->initialize(g);
     }
+  // the players have their armysets now, so colour their army images.
+  ImageCache::getInstance()->prewarm(GameScenario::load_tick.make_slot());
   start_game_progress_tick.emit ();
   return game_scenario;
 }
@@ -1134,6 +1136,9 @@ GameScenario *Driver::load_game(Glib::ustring file_path, Gtk::Window *w)
       (sigc::mem_fun (p, &LoadProgressWindow::finish_progress));
     p->run ();
     GameScenario* game_scenario = new GameScenario(file_path, broken);
+    // colour the army images while the progress bar is still up.
+    if (!broken)
+      ImageCache::getInstance()->prewarm(GameScenario::load_tick.make_slot());
     p->hide ();
 
     if (broken)
@@ -34,6 +34,7 @@
 #include "game-client.h"
 #include "game-server.h"
 #include "shieldsetlist.h"
+#include "GameMap.h"
 #include "NextTurnNetworked.h"
 #include "recently-played-game-list.h"
 #include "game-parameters.h"
@@ -81,8 +82,8 @@ void GameLobbyDialog::initDialog(GameScenario *gamescenario,
 				 NextTurnNetworked *next_turn,
 				 GameStation *game_station)
 {
-  bool broken = false;
-  Shieldsetlist::getInstance()->instantiateImages(broken);
+  // the map loads the images of its shieldset.
+  GameMap::getShieldset();
   d_game_scenario = gamescenario;
   d_game_station = game_station;
   d_next_turn = next_turn;
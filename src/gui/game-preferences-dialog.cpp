@@ -225,7 +225,7 @@ void GamePreferencesDialog::update_shields()
   if (dialog->get_realized() == false)
     return;
   bool broken = false;
-  Shieldsetlist::getInstance()->instantiateImages(broken);
+  Shieldsetlist::getInstance()->ensureImages(d_shieldset, broken);
 
   std::vector<Gtk::Widget*> list;
   list = players_vbox->get_children();
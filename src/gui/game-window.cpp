@@ -991,6 +991,9 @@ void GameWindow::on_game_stopped()
         (sigc::mem_fun (p, &LoadProgressWindow::finish_progress));
       p->run ();
       GameScenario* game_scenario = new GameScenario(d_load_filename, broken);
+      // colour the army images while the progress bar is still up.
+      if (!broken)
+        ImageCache::getInstance()->prewarm(GameScenario::load_tick.make_slot());
       p->hide ();
 
       if (broken)
@@ -39,7 +39,12 @@ disassemble_row(const Glib::ustring &file, int no, bool &broken)
       std::vector<PixMask*> empty;
       return  empty;
     }
+  return disassemble_row(row, no);
+}
 
+std::vector<PixMask*>
+disassemble_row(Glib::RefPtr<Gdk::Pixbuf> row, int no)
+{
     std::vector<Glib::RefPtr<Gdk::Pixbuf> > images;
     images.reserve(no);
   
@@ -31,6 +31,8 @@ disassemble_row(const Glib::ustring &file, int no, bool &broken);
 std::vector<PixMask*>
 disassemble_row(const Glib::ustring &file, int no, bool first_half_height, bool &broken);
 std::vector<PixMask*>
+disassemble_row(Glib::RefPtr<Gdk::Pixbuf> p, int no);
+std::vector<PixMask*>
 disassemble_row(Glib::RefPtr<Gdk::Pixbuf> p, int no, bool first_half_height);
 
 //Cairo::RefPtr<Cairo::Surface> scale (Cairo::RefPtr<Cairo::Surface> pixmap, int w, int h);
@@ -66,6 +66,8 @@ LoadScenarioDialog::LoadScenarioDialog(Gtk::Window &parent)
 
   for (auto j : *ScenarioList::getInstance ())
     add_scenario (j, false);
+  refreshed = ScenarioList::getInstance ()->details_refreshed.connect
+    (method(on_details_refreshed));
 
   Gtk::TreeModel::Row row;
   row = scenarios_treeview->get_model()->children()[0];
@@ -160,6 +162,17 @@ void LoadScenarioDialog::add_scenario(ScenarioDetails *d, bool sel)
 
 }
 
+void LoadScenarioDialog::on_details_refreshed(ScenarioDetails *d)
+{
+  scenarios_treeview->queue_draw ();
+  Gtk::TreeIter i = scenarios_treeview->get_selection()->get_selected();
+  if (!i)
+    return;
+  ScenarioDetails *details = (*i)[scenarios_columns.details];
+  if (details == d)
+    on_selection_changed ();
+}
+
 void LoadScenarioDialog::on_selection_changed()
 {
   Gtk::TreeIter i = scenarios_treeview->get_selection()->get_selected();
@@ -31,7 +31,7 @@ class LoadScenarioDialog: public LwDialog
 {
  public:
     LoadScenarioDialog(Gtk::Window &parent);
-    ~LoadScenarioDialog() {};
+    ~LoadScenarioDialog() {refreshed.disconnect ();};
 
     void run();
     void hide() {dialog->hide();};
@@ -70,6 +70,8 @@ class LoadScenarioDialog: public LwDialog
     void on_remove_scenario_clicked();
     int copy_file (Glib::ustring from, Glib::ustring to);
     void on_scenario_activated();
+    void on_details_refreshed(ScenarioDetails *d);
+    sigc::connection refreshed;
 
     Gtk::Box *dialog_vbox;
     Gtk::TreeView *progress_treeview;
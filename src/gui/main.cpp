@@ -41,10 +41,15 @@
 #include "driver.h"
 #include "defs.h"
 #include "File.h"
+#include "ucompose.hpp"
 #include "Configuration.h"
 #include "timing.h"
+#include "draw-stats.h"
+#include "autosave-worker.h"
 #include "fight-window.h"
 
+//! How often the draw stats are written out, in milliseconds.
+#define DRAW_STATS_INTERVAL 5000
 
 struct Main::Impl: public sigc::trackable 
 {
@@ -85,6 +90,9 @@ Main::Main()
 
 Main::~Main()
 {
+    DrawStats::deleteInstance();
+    // let the last autosave finish before we go.
+    AutosaveWorker::deleteInstance();
     delete impl->driver;
     impl->app->quit ();
     delete impl;
@@ -154,6 +162,11 @@ void Main::initialize ()
   initialize_configuration();
   if (cacheSize)
     Configuration::s_cacheSize = cacheSize;
+  if (draw_stats_file != "" &&
+      DrawStats::getInstance()->start(draw_stats_file,
+                                      DRAW_STATS_INTERVAL) == false)
+    std::cerr << String::ucompose(_("Error: Couldn't open `%1' for writing."),
+                                  draw_stats_file) << std::endl;
   Profilelist::support_backward_compatibility();
   RecentlyPlayedGameList::support_backward_compatibility();
   Gamelist::support_backward_compatibility();
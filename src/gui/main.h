@@ -57,6 +57,7 @@ class Main: public sigc::trackable
     std::string configuration_file_path;
     std::string save_path;
     Glib::ustring save_server_messages;
+    Glib::ustring draw_stats_file;
     
  private:
     struct Impl;
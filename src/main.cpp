@@ -162,6 +162,16 @@ int main(int argc, char* argv[])
                 }
 	      kit.save_server_messages = argv[i-1];
             }
+          else if (parameter == "--draw-stats")
+            {
+	      i++;
+              if (i - 1 >= argc)
+		{
+                  std::cerr <<_("missing argument for --draw-stats") <<std::endl;
+		  exit(-1);
+                }
+	      kit.draw_stats_file = argv[i-1];
+            }
 	  else if (parameter == "--help" || parameter == "-h")
 	    {
               std::cout << Glib::get_prgname() << " [OPTION]... [FILE]" << std::endl << std::endl;
@@ -177,6 +187,7 @@ int main(int argc, char* argv[])
               std::cout << "  -H, --host                 " << _("Start a headless server") << std::endl;
               std::cout << "  -p, --port <number>        " << _("Start the server on the given port") << std::endl;
               std::cout << "      --editor               " << _("Start the scenario builder") << std::endl;
+              std::cout << "      --draw-stats <file>    " << _("Write how long the maps take to draw to FILE") << std::endl;
               std::cout << "  -h, --help                 " << _("Shows this help screen") <<std::endl;
               std::cout << std::endl;
               std::cout << _("FILE can be a saved game file (.sav), or a map (.map) file.") << std::endl;
@@ -90,7 +90,7 @@ class NetworkPlayer : public Player
         ~NetworkPlayer() {};
 
         //! Saves the data
-        virtual bool save(XML_Helper* helper) const;
+        virtual bool save(XML_Helper* helper, guint32 skip_history = 0) const;
 
 	virtual bool isComputer() const {return false;};
         
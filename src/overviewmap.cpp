@@ -20,6 +20,7 @@
 
 #include <config.h>
 #include <assert.h>
+#include <algorithm>
 #include <cairomm/context.h>
 
 #include "overviewmap.h"
@@ -44,6 +45,7 @@
 #include "rnd.h"
 #include "gui/font-size.h"
 #include "bigmap.h"
+#include "draw-stats.h"
 
 OverviewMap::OverviewMap(bool headless)
 {
@@ -131,15 +133,6 @@ void OverviewMap::choose_surface(bool front, Cairo::RefPtr<Cairo::Surface> &surf
     }
 }
 
-void
-OverviewMap::draw_pixel(Cairo::RefPtr<Cairo::Context> gc, int x, int y, const Gdk::RGBA color)
-{
-  gc->set_source_rgba(color.get_red(), color.get_green(), color.get_blue(), color.get_alpha());
-  gc->rectangle(x, y, 1, 1);
-  gc->fill();
-  return;
-}
-
 void
 OverviewMap::draw_filled_rect(int x, int y, int width, int height, const Gdk::RGBA color)
 {
@@ -157,6 +150,13 @@ OverviewMap::draw_filled_rect(bool front, int x, int y, int width, int height, c
   gc->fill();
 }
 
+void
+OverviewMap::fill(const Gdk::RGBA color)
+{
+  surface_gc->set_source_rgba(color.get_red(), color.get_green(), color.get_blue(), color.get_alpha());
+  surface_gc->fill();
+}
+
 void
 OverviewMap::draw_line(int src_x, int src_y, int dst_x, int dst_y, const Gdk::RGBA color)
 {
@@ -198,132 +198,45 @@ OverviewMap::draw_rect(bool front, int x, int y, int width, int height, const Gd
       gc->stroke();
 }
 
-void OverviewMap::draw_terrain_tile(Cairo::RefPtr<Cairo::Context> gc,
-				    SmallTile::Pattern pattern,
-				    Gdk::RGBA first,
-				    Gdk::RGBA second,
-				    Gdk::RGBA third,
-				    int i, int j, bool shadowed)
+int OverviewMap::get_pattern_color(SmallTile::Pattern pattern, int i, int j,
+                                   bool shadowed)
 {
-
   switch (pattern)
     {
       case SmallTile::SOLID:
-        draw_pixel(gc, i, j, first);
-        break;
+        return 0;
       case SmallTile::STIPPLED:
-        {
-          if ((i+j) % 2 == 0)
-            draw_pixel(gc, i, j, first);
-          else
-            draw_pixel(gc, i, j, second);
-        }
-        break;
+        return (i+j) % 2 == 0 ? 0 : 1;
       case SmallTile::RANDOMIZED:
-        {
-          int num = prand(i, j) % 3;
-          if (num == 0)
-            draw_pixel(gc, i, j, first);
-          else if (num == 1)
-            draw_pixel(gc, i, j, second);
-          else
-            draw_pixel(gc, i, j, third);
-        }
-        break;
+        return prand(i, j) % 3;
       case SmallTile::DIAGONAL:
-        {
-          int num = drand(i, j) % 3;
-          if (num == 0)
-            draw_pixel(gc, i, j, first);
-          else if (num == 1)
-            draw_pixel(gc, i, j, second);
-          else
-            draw_pixel(gc, i, j, third);
-        }
-        break;
+        return drand(i, j) % 3;
       case SmallTile::CROSSHATCH:
-        {
-          int num = crand(i, j) % 3;
-          if (num == 0)
-            draw_pixel(gc, i, j, first);
-          else if (num == 1)
-            draw_pixel(gc , i, j, second);
-          else
-            draw_pixel(gc, i, j, third);
-        }
-        break;
+        return crand(i, j) % 3;
       case SmallTile::SUNKEN:
-        if (shadowed == false)
-          draw_pixel(gc, i, j, first);
-        else
-          {
-            draw_pixel(gc, i, j, second);
-          }
-        break;
+        return shadowed ? 1 : 0;
       case SmallTile::SUNKEN_STRIPED:
-        if (shadowed == false)
-	  {
-	    if (j % 2 == 0)
-	      draw_pixel(gc, i, j, first);
-	    else
-	      draw_pixel(gc, i, j, third);
-	  }
-        else
-          {
-            draw_pixel(gc, i, j, second);
-          }
-        break;
+        if (shadowed)
+          return 1;
+        return j % 2 == 0 ? 0 : 2;
       case SmallTile::TABLECLOTH:
-          {
-            if (i % 4 == 0 && j % 4 == 0)
-              draw_pixel(gc, i, j, first);
-            else if (i % 4 == 0 && j % 4 == 1)
-              draw_pixel(gc, i, j, second);
-            else if (i % 4 == 0 && j % 4 == 2)
-              draw_pixel(gc, i, j, first);
-            else if (i % 4 == 0 && j % 4 == 3)
-              draw_pixel(gc, i, j, second);
-            else if (i % 4 == 1 && j % 4 == 0)
-              draw_pixel(gc, i, j, second);
-            else if (i % 4 == 1 && j % 4 == 1)
-              draw_pixel(gc, i, j, third);
-            else if (i % 4 == 1 && j % 4 == 2)
-              draw_pixel(gc, i, j, second);
-            else if (i % 4 == 1 && j % 4 == 3)
-              draw_pixel(gc, i, j, third);
-            else if (i % 4 == 2 && j % 4 == 0)
-              draw_pixel(gc, i, j, first);
-            else if (i % 4 == 2 && j % 4 == 1)
-              draw_pixel(gc, i, j, second);
-            else if (i % 4 == 2 && j % 4 == 2)
-              draw_pixel(gc, i, j, first);
-            else if (i % 4 == 2 && j % 4 == 3)
-              draw_pixel(gc, i, j, second);
-            else if (i % 4 == 3 && j % 4 == 0)
-              draw_pixel(gc, i, j, second);
-            else if (i % 4 == 3 && j % 4 == 1)
-              draw_pixel(gc, i, j, third);
-            else if (i % 4 == 3 && j % 4 == 2)
-              draw_pixel(gc, i, j, second);
-            else if (i % 4 == 3 && j % 4 == 3)
-              draw_pixel(gc, i, j, third);
-          }
-        break;
+        // first and second on the even columns, second and third on the
+        // odd ones.
+        return (i % 2) + (j % 2);
       case SmallTile::SUNKEN_RADIAL:
-        if (shadowed == true)
-          draw_pixel(gc, i, j, third);
-        break;
+        return shadowed ? 2 : -1;
     }
+  return -1;
 }
 
-void OverviewMap::draw_terrain_tile(Maptile *t, int i, int j)
+//! Pack a colour into a premultiplied ARGB32 pixel.
+static guint32 pack_color(const Gdk::RGBA &c)
 {
-  bool shadowed = isShadowed(t->getType(), i, j);
-  draw_terrain_tile (static_surface_gc, t->getPattern(),
-		     t->getColor(),
-		     t->getSecondColor(),
-		     t->getThirdColor(),
-		     i, j, shadowed);
+  guint32 a = guint32(round(c.get_alpha() * 255.0));
+  guint32 r = guint32(round(c.get_red() * a));
+  guint32 g = guint32(round(c.get_green() * a));
+  guint32 b = guint32(round(c.get_blue() * a));
+  return (a << 24) | (r << 16) | (g << 8) | b;
 }
 
 int OverviewMap::calculatePixelsPerTile(int width, int height)
@@ -400,49 +313,32 @@ void OverviewMap::resize(Vector<int> max_dimensions, float scale)
     d.x /= map_tiles_per_tile;
     d.y /= map_tiles_per_tile;
 
-    Cairo::RefPtr<Cairo::Surface> empty = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, d.x, d.y);
-    static_surface = Cairo::Surface::create(empty, Cairo::CONTENT_COLOR_ALPHA, d.x, d.y);
+    static_surface = Cairo::ImageSurface::create (Cairo::FORMAT_ARGB32, d.x, d.y);
     static_surface_gc = Cairo::Context::create(static_surface);
 
-    Tileset *ts = GameMap::getTileset();
-    Tile *tile = ts->getFirstTile(SmallTile::SUNKEN_RADIAL);
-    if (tile)
-      draw_radial_gradient(tile->getSmallTile()->getColor(),
-                           tile->getSmallTile()->getSecondColor(), d.x, d.y);
     draw_terrain_tiles(LwRectangle(0, 0, d.x, d.y));
-    surface = Cairo::Surface::create(empty, Cairo::CONTENT_COLOR_ALPHA, d.x, d.y);
+    surface = Cairo::Surface::create(static_surface, Cairo::CONTENT_COLOR_ALPHA, d.x, d.y);
     surface_gc = Cairo::Context::create(surface);
-
+    DrawStats::count(DrawStats::SURFACES_ALLOCATED, 2);
 }
 
 void OverviewMap::redraw_tiles(LwRectangle tiles)
 {
-    if (tiles.w > 0 && tiles.h > 0)
+  if (tiles.w > 0 && tiles.h > 0 && static_surface)
     {
-	tiles.pos -= Vector<int>(1, 1);
-	tiles.dim += Vector<int>(2, 2);
-	
-	// translate to pixel coordinates
-	Vector<int> pos(int(round(tiles.x * pixels_per_tile)),
-			int(round(tiles.y * pixels_per_tile)));
-	Vector<int> dim(int(round(tiles.w * pixels_per_tile)),
-			int(round(tiles.h * pixels_per_tile)));
-
-	int width = get_width();
-	int height = get_height();
-	// ensure we're within bounds
-	pos = clip(Vector<int>(0, 0), pos,
-		   Vector<int>(width, height) - Vector<int>(1, 1));
-
-	if (pos.x + dim.x >= int(GameMap::getWidth() * pixels_per_tile))
-	    dim.x = int(GameMap::getWidth() * pixels_per_tile) - pos.x;
-	
-	if (pos.y + dim.y >= int(GameMap::getHeight() * pixels_per_tile))
-	    dim.y = int(GameMap::getHeight() * pixels_per_tile) - pos.y;
-
-	draw_terrain_tiles(LwRectangle(pos, dim));
+      // the shadows of sunken tiles fall on their neighbours.
+      tiles.pos -= Vector<int>(1, 1);
+      tiles.dim += Vector<int>(2, 2);
+
+      // translate to pixel coordinates
+      double ratio = pixels_per_tile / map_tiles_per_tile;
+      int x1 = int(floor(tiles.x * ratio));
+      int y1 = int(floor(tiles.y * ratio));
+      int x2 = int(ceil((tiles.x + tiles.w) * ratio));
+      int y2 = int(ceil((tiles.y + tiles.h) * ratio));
+      draw_terrain_tiles(LwRectangle(x1, y1, x2 - x1, y2 - y1));
     }
-    draw();
+  draw();
 }
 
 Maptile* OverviewMap::getTile(int x, int y)
@@ -473,33 +369,85 @@ Maptile* OverviewMap::getTile(int x, int y)
 
 void OverviewMap::draw_terrain_tiles(LwRectangle r)
 {
-  Gdk::RGBA rd = GameMap::getTileset()->getRoadColor();
-  r.w *= map_tiles_per_tile;
-  r.h *= map_tiles_per_tile;
-  for (int i = r.x; i < r.x + r.w; i += int(map_tiles_per_tile))
-    for (int j = r.y; j < r.y + r.h; j += int(map_tiles_per_tile))
-      {
-        int x = int(i / pixels_per_tile);
-        int y = int(j / pixels_per_tile);
-        Maptile *mtile = getTile(x,y);
-        draw_terrain_tile (mtile, i /map_tiles_per_tile, j /map_tiles_per_tile);
-      }
+  r = intersect(r, LwRectangle(0, 0, static_surface->get_width(),
+                               static_surface->get_height()));
+  if (r.w <= 0 || r.h <= 0)
+    return;
+  DrawStats::count(DrawStats::OVERVIEW_PIXELS_DRAWN, r.w * r.h);
+
+  Tileset *ts = GameMap::getTileset();
 
+  // the radial tiles only draw their shadows, and let this show through.
+  Tile *radial = ts->getFirstTile(SmallTile::SUNKEN_RADIAL);
+  if (radial)
+    {
+      static_surface_gc->save();
+      static_surface_gc->rectangle(r.x, r.y, r.w, r.h);
+      static_surface_gc->clip();
+      static_surface_gc->set_source
+        (make_radial_gradient(radial->getSmallTile()->getColor(),
+                              radial->getSmallTile()->getSecondColor(),
+                              static_surface->get_width(),
+                              static_surface->get_height()));
+      static_surface_gc->paint();
+      static_surface_gc->restore();
+    }
+
+  // Put the terrain straight into the pixels of the surface.  Neighbouring
+  // pixels are mostly on the same map tile, so we hang onto the last tile
+  // and its colours.
+  static_surface->flush();
+  unsigned char *data = static_surface->get_data();
+  int stride = static_surface->get_stride();
+  int step = int(map_tiles_per_tile);
+  Maptile *mtile = NULL;
+  int last_x = -1, last_y = -1;
+  guint32 colors[3];
+  bool sunken = false;
+  for (int j = r.y; j < r.y + r.h; j++)
+    {
+      guint32 *row = (guint32*)(data + j * stride);
+      int y = std::min(int(j * step / pixels_per_tile), GameMap::getHeight() - 1);
+      for (int i = r.x; i < r.x + r.w; i++)
+        {
+          int x = std::min(int(i * step / pixels_per_tile), GameMap::getWidth() - 1);
+          if (x != last_x || y != last_y)
+            {
+              mtile = getTile(x, y);
+              last_x = x;
+              last_y = y;
+              colors[0] = pack_color(mtile->getColor());
+              colors[1] = pack_color(mtile->getSecondColor());
+              colors[2] = pack_color(mtile->getThirdColor());
+              sunken = mtile->getPattern() == SmallTile::SUNKEN ||
+                mtile->getPattern() == SmallTile::SUNKEN_STRIPED ||
+                mtile->getPattern() == SmallTile::SUNKEN_RADIAL;
+            }
+          bool shadowed = sunken && isShadowed(mtile->getType(), i, j);
+          int c = get_pattern_color(mtile->getPattern(), i, j, shadowed);
+          if (c >= 0)
+            row[i] = colors[c];
+        }
+    }
+  static_surface->mark_dirty(r.x, r.y, r.w, r.h);
+
+  // the roads and bridges go on top, all in one go.
+  Gdk::RGBA rd = ts->getRoadColor();
   int size = int(pixels_per_tile) > 1 ? int(pixels_per_tile) : 1;
+  static_surface_gc->set_source_rgba(rd.get_red(), rd.get_green(),
+                                     rd.get_blue(), rd.get_alpha());
+  auto add_road = [&] (Vector<int> pos)
+    {
+      pos = mapToSurface(pos);
+      pos -= Vector<int>(size,size) / 2;
+      if (intersect(r, LwRectangle(pos.x, pos.y, size, size)).w > 0)
+        static_surface_gc->rectangle(pos.x, pos.y, size, size);
+    };
   for (auto it : *Roadlist::getInstance())
-      {
-        Vector<int> pos = it->getPos();
-        pos = mapToSurface(pos);
-        pos -= Vector<int>(size,size) / 2;
-	draw_filled_rect(false, pos.x, pos.y, size, size, rd);
-      }
+    add_road(it->getPos());
   for (auto it : *Bridgelist::getInstance())
-      {
-        Vector<int> pos = it->getPos();
-        pos = mapToSurface(pos);
-        pos -= Vector<int>(size,size) / 2;
-	draw_filled_rect(false, pos.x, pos.y, size, size, rd);
-      }
+    add_road(it->getPos());
+  static_surface_gc->fill();
 }
 
 void OverviewMap::after_draw()
@@ -508,6 +456,7 @@ void OverviewMap::after_draw()
 
 void OverviewMap::draw()
 {
+  DrawStats::Timer timer(DrawStats::OVERVIEWMAP_DRAW);
   if (d_headless)
     return;
   Tileset *ts = GameMap::getTileset();
@@ -525,8 +474,10 @@ void OverviewMap::draw()
   surface_gc->set_source(static_surface, 0, 0);
   surface_gc->paint();
 
-  // Draw ruins as a white dot
+  // The dots and the fog are each drawn as one path, so that there's only
+  // one fill per colour.
 
+  // Draw ruins as a white dot
   Gdk::RGBA ruindotcolor = ts->getRuinColor();
   for (Ruinlist::iterator it = Ruinlist::getInstance()->begin();
        it != Ruinlist::getInstance()->end(); ++it)
@@ -543,8 +494,9 @@ void OverviewMap::draw()
       Vector<int> pos = r->getPos();
       pos = mapToSurface(pos);
 
-      draw_filled_rect(true, pos.x, pos.y, size, size, ruindotcolor);
+      surface_gc->rectangle(pos.x, pos.y, size, size);
     }
+  fill(ruindotcolor);
 
   // Draw temples as a white dot
   Gdk::RGBA templedotcolor = ts->getTempleColor();
@@ -557,27 +509,9 @@ void OverviewMap::draw()
       Vector<int> pos = t->getPos();
       pos = mapToSurface(pos);
 
-      draw_filled_rect(true, pos.x, pos.y, size, size, templedotcolor);
-    }
-
-  //fog it up
-  if (GameScenarioOptions::s_hidden_map == true)
-    {
-      for (int i = 0; i < GameMap::getWidth(); i++)
-        for (int j = 0; j < GameMap::getHeight(); j++)
-          {
-            Vector <int> pos = Vector<int>(i, j);
-            if (Playerlist::getViewingplayer()->getFogMap()->isFogged(pos) == true)
-              {
-                pos = mapToSurface(pos);
-                draw_filled_rect(true, pos.x, pos.y, size, size, FOG_COLOR);
-                if (i == 0)
-                  draw_filled_rect(true, pos.x-size, pos.y, size, size, FOG_COLOR);
-                if (j == 0)
-                  draw_filled_rect(true, pos.x, pos.y-size, size, size, FOG_COLOR);
-              }
-          }
+      surface_gc->rectangle(pos.x, pos.y, size, size);
     }
+  fill(templedotcolor);
 
   if (Playerlist::getActiveplayer()->getType() != Player::HUMAN &&
       GameScenarioOptions::s_hidden_map == true)
@@ -586,6 +520,29 @@ void OverviewMap::draw()
       int height = get_height();
       draw_filled_rect(true, 0, 0, width, height, FOG_COLOR);
     }
+  else if (GameScenarioOptions::s_hidden_map == true)
+    {
+      //fog it up, a run of fogged tiles at a time.
+      FogMap *fogmap = Playerlist::getViewingplayer()->getFogMap();
+      for (int j = 0; j < GameMap::getHeight(); j++)
+        for (int i = 0; i < GameMap::getWidth(); i++)
+          {
+            if (fogmap->isFogged(Vector<int>(i, j)) == false)
+              continue;
+            int end = i + 1;
+            while (end < GameMap::getWidth() &&
+                   fogmap->isFogged(Vector<int>(end, j)))
+              end++;
+            Vector<int> start = mapToSurface(Vector<int>(i, j));
+            Vector<int> last = mapToSurface(Vector<int>(end - 1, j));
+            int x = i == 0 ? start.x - size : start.x;
+            int y = j == 0 ? start.y - size : start.y;
+            surface_gc->rectangle(x, y, last.x + size - x,
+                                  start.y + size - y);
+            i = end - 1;
+          }
+      fill(FOG_COLOR);
+    }
 
   if (blank_screen)
     {
@@ -745,15 +702,8 @@ void OverviewMap::draw_square_around_city(City *c, Gdk::RGBA color)
   draw_rect (start.x-0, start.y-0, end.x-start.x+0, end.y-start.y+0, color);
 }
 
-void OverviewMap::draw_radial_gradient(Cairo::RefPtr<Cairo::Surface> surface, Gdk::RGBA inner, Gdk::RGBA outer, int width, int height)
+Cairo::RefPtr<Cairo::RadialGradient> OverviewMap::make_radial_gradient(Gdk::RGBA inner, Gdk::RGBA outer, int width, int height)
 {
-  double ired = inner.get_red();
-  double igreen = inner.get_green();
-  double iblue = inner.get_blue();
-  double ored = outer.get_red();
-  double ogreen = outer.get_green();
-  double oblue = outer.get_blue();
-  Cairo::RefPtr<Cairo::Context> cr = Cairo::Context::create(surface);
   double max = (double) width;
   if ((double)height > max)
     max = (double)width;
@@ -761,15 +711,18 @@ void OverviewMap::draw_radial_gradient(Cairo::RefPtr<Cairo::Surface> surface, Gd
   double ycenter = (double)height / 2.0;
   Cairo::RefPtr<Cairo::RadialGradient> gradient =
     Cairo::RadialGradient::create(xcenter, ycenter, 1, xcenter, ycenter, max);
-  gradient->add_color_stop_rgb(0, ired, igreen, iblue);
-  gradient->add_color_stop_rgb(1.0, ored, ogreen, oblue);
-  cr->set_source(gradient);
-  cr->paint();
+  gradient->add_color_stop_rgb(0, inner.get_red(), inner.get_green(),
+                               inner.get_blue());
+  gradient->add_color_stop_rgb(1.0, outer.get_red(), outer.get_green(),
+                               outer.get_blue());
+  return gradient;
 }
 
-void OverviewMap::draw_radial_gradient(Gdk::RGBA inner, Gdk::RGBA outer, int width, int height)
+void OverviewMap::draw_radial_gradient(Cairo::RefPtr<Cairo::Surface> surface, Gdk::RGBA inner, Gdk::RGBA outer, int width, int height)
 {
-  return draw_radial_gradient(static_surface, inner, outer, width, height);
+  Cairo::RefPtr<Cairo::Context> cr = Cairo::Context::create(surface);
+  cr->set_source(make_radial_gradient(inner, outer, width, height));
+  cr->paint();
 }
 
 int OverviewMap::get_width()
@@ -105,12 +105,13 @@ class OverviewMap : public sigc::trackable
     //! Redraw a portion of the map graphic.
     /**
      * This method draws the terrain (water, grass, etc) for the given 
-     * portion of the screen.
+     * portion of the map, and leaves the rest of the terrain alone.  Call
+     * it after the map has been changed.
      *
      * @note This method redraws all terrain features (roads, ruins, etc), 
      *       including the features outside of the given portion.
      *
-     * @param tiles  The rectangle to redraw.
+     * @param tiles  The rectangle to redraw, in map tiles.
      */
     void redraw_tiles(LwRectangle tiles);
 
@@ -122,14 +123,13 @@ class OverviewMap : public sigc::trackable
     Cairo::RefPtr<Cairo::Surface> get_surface();
 
 
-    static void draw_terrain_tile (Cairo::RefPtr<Cairo::Context> gc,
-				SmallTile::Pattern pattern,
-				Gdk::RGBA first, 
-				Gdk::RGBA second,
-				Gdk::RGBA third,
-				int i, int j, bool shadowed);
-
-    static void draw_pixel(Cairo::RefPtr<Cairo::Context> gc, int x, int y, const Gdk::RGBA color);
+    //! Which of the three colours of a pattern goes on the given pixel.
+    /**
+     * @return 0 for the first colour, 1 for the second, 2 for the third,
+     *         or -1 when the pixel is left alone.
+     */
+    static int get_pattern_color(SmallTile::Pattern pattern, int i, int j,
+                                 bool shadowed);
 
 
     void draw_filled_rect(int x, int y, int width, int height, const Gdk::RGBA color);
@@ -170,22 +170,6 @@ class OverviewMap : public sigc::trackable
      */
     bool isShadowed(Tile::Type type, int i, int j);
 
-    //! Draw the given tile at the given pixel location on the map.
-    /**
-     * This method draws a square that is Overviewmap::pixels_per_tile pixels
-     * in height and width.  It draws it at position (i,j) on the graphic.
-     * This method uses the pattern assocaited the given Maptile to know 
-     * what this box should look like.
-     *
-     * @param tile  The tile of the game map we're trying to draw.
-     * @param i     The pixel on the horizontal axis of the map graphic.  This
-     *              value must be a multiple of OverviewMap::pixels_per_tile.
-     * @param j     The pixel on the vertical axis of the map graphic.  This
-     *              value must be a multiple of OverviewMap::pixels_per_tile.
-     */
-    void draw_terrain_tile (Maptile *tile, int i, int j);
-
-
     void choose_surface(bool front, Cairo::RefPtr<Cairo::Surface> &surf,
 				 Cairo::RefPtr<Cairo::Context> &gc);
     void draw_filled_rect(bool front, int x, int y, int width, int height, Gdk::RGBA color);
@@ -193,6 +177,11 @@ class OverviewMap : public sigc::trackable
     void draw_rect(bool front, int x, int y, int width, int height, Gdk::RGBA color);
 
     void draw_line(bool front, int src_x, int src_y, int dst_x, int dst_y, Gdk::RGBA color);
+
+    //! Fill the current path on the map graphic with the given colour.
+    void fill(const Gdk::RGBA color);
+
+    static Cairo::RefPtr<Cairo::RadialGradient> make_radial_gradient(Gdk::RGBA inner, Gdk::RGBA outer, int width, int height);
  protected:
 
     //! Every pixel on the graphic is this wide and tall.  2 is normal.
@@ -234,7 +223,11 @@ class OverviewMap : public sigc::trackable
     //! Draw a hero icon at the given location.  white or black.
     void draw_hero(Vector<int> pos, bool white);
 
-    //! Redraw the specified region.
+    //! Redraw the terrain in the specified region, in pixels.
+    /**
+     * The terrain patterns are written straight into the pixels of the
+     * static surface, and the roads are drawn over them.
+     */
     void draw_terrain_tiles(LwRectangle r);
 
     //! Returns a maptile, but takes map_tiles_per_tile into account.
@@ -245,7 +238,7 @@ class OverviewMap : public sigc::trackable
      * This is the cached surface after the resize method was called.
      * It is cached so that we don't have recalculate it.
      */
-    Cairo::RefPtr<Cairo::Surface> static_surface;
+    Cairo::RefPtr<Cairo::ImageSurface> static_surface;
     Cairo::RefPtr<Cairo::Context> static_surface_gc;
 
     //! The surface containing the drawn map.
@@ -254,7 +247,6 @@ class OverviewMap : public sigc::trackable
 
     void draw_target_box(Vector<int> pos, const Gdk::RGBA color);
     void draw_square_around_city(City *c, const Gdk::RGBA color);
-    void draw_radial_gradient(Gdk::RGBA inner, Gdk::RGBA outer, int width, int height);
 
     bool blank_screen;
     bool d_headless;
@@ -0,0 +1,101 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#include <string.h>
+#include "packed-grid.h"
+
+//! Packed grids start with this.  The number goes up if the packing changes.
+#define PACKED_GRID_PREFIX "rle1:"
+#define PACKED_GRID_PREFIX_SIZE 5
+
+static void put_varint(std::string &out, guint32 value)
+{
+  while (value >= 0x80)
+    {
+      out.push_back(char((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+  out.push_back(char(value));
+}
+
+static bool get_varint(const unsigned char *&p, const unsigned char *end,
+                       guint32 &value)
+{
+  guint64 v = 0;
+  for (int shift = 0; p < end && shift < 35; shift += 7)
+    {
+      unsigned char b = *p++;
+      v |= guint64(b & 0x7f) << shift;
+      if ((b & 0x80) == 0)
+        {
+          value = v;
+          return v <= G_MAXUINT32;
+        }
+    }
+  return false;
+}
+
+Glib::ustring PackedGrid::pack(const std::vector<guint32> &values)
+{
+  std::string bytes;
+  for (size_t i = 0; i < values.size(); )
+    {
+      size_t j = i + 1;
+      while (j < values.size() && values[j] == values[i])
+        j++;
+      put_varint(bytes, values[i]);
+      put_varint(bytes, j - i);
+      i = j;
+    }
+  return PACKED_GRID_PREFIX + Glib::Base64::encode(bytes);
+}
+
+bool PackedGrid::isPacked(const Glib::ustring &text)
+{
+  return strncmp(text.c_str(), PACKED_GRID_PREFIX,
+                 PACKED_GRID_PREFIX_SIZE) == 0;
+}
+
+bool PackedGrid::unpack(const Glib::ustring &text, guint32 count,
+                        std::vector<guint32> &values)
+{
+  values.clear();
+  values.reserve(count);
+  bool retval = isPacked(text);
+  if (retval)
+    {
+      std::string bytes =
+        Glib::Base64::decode(text.raw().substr(PACKED_GRID_PREFIX_SIZE));
+      const unsigned char *p = (const unsigned char*)bytes.data();
+      const unsigned char *end = p + bytes.size();
+      while (p < end)
+        {
+          guint32 value = 0, run = 0;
+          if (!get_varint(p, end, value) || !get_varint(p, end, run) ||
+              run > count - values.size())
+            {
+              retval = false;
+              break;
+            }
+          values.insert(values.end(), run, value);
+        }
+    }
+  if (values.size() != count)
+    retval = false;
+  values.resize(count, 0);
+  return retval;
+}
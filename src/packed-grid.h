@@ -0,0 +1,58 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#pragma once
+#ifndef PACKED_GRID_H
+#define PACKED_GRID_H
+
+#include <vector>
+#include <glibmm.h>
+
+//! Writes grids of numbers, like the terrain of a map, compactly.
+/**
+ * The grids in saved-game and map files used to be written as a character
+ * or a few for every tile, with a line for every row.  Maps are mostly long
+ * runs of the same thing, so now a grid is written as runs instead: the
+ * value and how many times it repeats, each as a variable-length number.
+ * The bytes are turned into base64 so that they can go into a data tag.
+ *
+ * Packed grids start with a prefix that says how they were packed, which
+ * also tells them apart from the grids written the old way.
+ */
+class PackedGrid
+{
+ public:
+    //! Returns the given values, row by row, packed into text.
+    static Glib::ustring pack(const std::vector<guint32> &values);
+
+    //! Returns whether the text is a packed grid, or the old text form.
+    static bool isPacked(const Glib::ustring &text);
+
+    //! Unpacks a grid that was packed with pack().
+    /**
+     * @param text       The packed grid.
+     * @param count      How many values the grid should have.
+     * @param values     Gets the values.  It always gets count of them,
+     *                   with zeros for any that couldn't be read.
+     *
+     * @return false if the text wasn't a packed grid of the given size.
+     */
+    static bool unpack(const Glib::ustring &text, guint32 count,
+                       std::vector<guint32> &values);
+};
+
+#endif // PACKED_GRID_H
@@ -427,7 +427,7 @@ void Player::doKill()
     d_diplomatic_title = Glib::ustring("");
 }
 
-bool Player::save(XML_Helper* helper) const
+bool Player::save(XML_Helper* helper, guint32 skip_history) const
 {
     bool retval = true;
 
@@ -488,8 +488,10 @@ bool Player::save(XML_Helper* helper) const
         retval &= it->save(helper);
     
     //save the pasteventlist
+    guint32 i = 0;
     for (auto it: d_history)
-      retval &= it->save(helper);
+      if (i++ >= skip_history)
+        retval &= it->save(helper);
 
     retval &= d_stacklist->save(helper);
     retval &= d_fogmap->save(helper);
@@ -1896,6 +1898,7 @@ void Player::doGiveReward(Stack *s, Reward *reward, StackReflist *stacks)
           Item *i = new Item (*dynamic_cast<Reward_Item*>(reward)->getItem());
           Hero *hero = static_cast<Hero*>(s->getFirstHero());
           hero->getBackpack()->addToBackpack(i);
+          s->invalidateCache();
         }
       break;
     case Reward::RUIN:
@@ -1972,6 +1975,7 @@ void Player::doHeroDropItem(Hero *h, Item *i, Vector<int> pos, bool &splash)
       h->getBackpack()->removeFromBackpack(i);
       splash = false;
     }
+  invalidateHeroStack(h);
   supdatingStack.emit(0);
 }
 
@@ -1996,6 +2000,7 @@ void Player::doHeroPickupItem(Hero *h, Item *i, Vector<int> pos)
   bool found = GameMap::getInstance()->getTile(pos)->getBackpack()->removeFromBackpack(i);
   if (found)
     h->getBackpack()->addToBackpack(i);
+  invalidateHeroStack(h);
   supdatingStack.emit(0);
 }
 
@@ -2210,6 +2215,7 @@ void Player::doHeroPlantStandard(Hero *hero, Item *item, Vector<int> pos)
   item->setPlanted(true);
   GameMap::getInstance()->getTile(pos)->getBackpack()->addToBackpack(item);
   hero->getBackpack()->removeFromBackpack(item);
+  invalidateHeroStack(hero);
   supdatingStack.emit(0);
 }
 
@@ -2325,6 +2331,14 @@ guint32 Player::removeDeadArmies(std::list<Stack*>& stacks,
 void Player::doHeroGainsLevel(Hero *hero, Army::Stat stat)
 {
   hero->gainLevel(stat);
+  invalidateHeroStack(hero);
+}
+
+void Player::invalidateHeroStack(Hero *hero)
+{
+  Stack *s = getStacklist()->getArmyStackById(hero->getId());
+  if (s)
+    s->invalidateCache();
 }
 
 void Player::updateArmyValues(std::list<Stack*>& stacks, double xp_sum)
@@ -2436,6 +2450,7 @@ void Player::updateArmyValues(std::list<Stack*>& stacks, double xp_sum)
 	      }
 	    ++sit;
 	  }
+      (*it)->invalidateCache();
       ++it;
     }
 }
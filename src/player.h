@@ -450,13 +450,15 @@ class Player: public sigc::trackable
 	 * Saves the player data to a file.
 	 *
 	 * @param helper     The opened saved-game file to write to.
+	 * @param skip_history  How many History events at the front to leave
+	 *                      out, because they are kept in a RoundJournal.
          *
          * @note This function only saves basic data, it doesn't open/close the
          * player tags, this has to be done by the derived methods in 
 	 * RealPlayer, AI_Fast, AI_Smart and AI_Dummy.
          */
 	//! Save the player to a saved-game file.
-        virtual bool save(XML_Helper* helper) const;
+        virtual bool save(XML_Helper* helper, guint32 skip_history = 0) const;
 
 
 
@@ -1639,6 +1641,9 @@ class Player: public sigc::trackable
         void doHeroPickupItem(Hero *hero, Item *item, Vector<int> pos);
         bool doHeroPickupAllItems(Hero *h, Vector<int> pos);
         void doHeroGainsLevel(Hero *hero, Army::Stat stat);
+
+        //! Forget the cached values of the stack that holds the given Hero.
+        void invalidateHeroStack(Hero *hero);
         bool doStackDisband(Stack *stack);
         void doStacksReset();
         void doRuinsReset();
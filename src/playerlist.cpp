@@ -39,6 +39,7 @@
 #include "ai_fast.h"
 #include "ai_dummy.h"
 #include "network_player.h"
+#include "round-journal.h"
 #include "GameMap.h"
 #include "shieldset.h"
 #include "shieldsetlist.h"
@@ -252,7 +253,7 @@ Player* Playerlist::getFirstLiving() const
             return (*it);
 }
 
-bool Playerlist::save(XML_Helper* helper) const
+bool Playerlist::save(XML_Helper* helper, bool journaled) const
 {
     bool retval = true;
 
@@ -264,7 +265,13 @@ bool Playerlist::save(XML_Helper* helper) const
     retval &= helper->saveData("neutral", d_neutral->getId());
 
     for (const_iterator it = begin(); it != end(); ++it)
-        retval &= (*it)->save(helper);
+      {
+        guint32 skip_history = 0;
+        if (journaled)
+          skip_history = RoundJournal::getInstance()->getHistories
+            ((*it)->getId());
+        retval &= (*it)->save(helper, skip_history);
+      }
 
     retval &= helper->closeTag();
 
@@ -231,7 +231,12 @@ class Playerlist : public std::list<Player*>, public sigc::trackable
         Player* getFirstLiving() const;
 
         //! Saves the playerlist to an opened saved-game file.
-        bool save(XML_Helper* helper) const;
+        /**
+         * @param helper     The opened saved-game file to write to.
+         * @param journaled  Whether to leave out the History events that
+         *                   are kept in the RoundJournal.
+         */
+        bool save(XML_Helper* helper, bool journaled = false) const;
 
 	//! Return the number of human players left alive in the list.
 	guint32 countHumanPlayersAlive() const;
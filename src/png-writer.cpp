@@ -0,0 +1,174 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#include <string.h>
+#include "png-writer.h"
+
+//! How much compressed data goes into each IDAT chunk.
+#define IDAT_SIZE 65536
+
+static void put_u32(unsigned char *p, guint32 v)
+{
+  p[0] = (v >> 24) & 0xff;
+  p[1] = (v >> 16) & 0xff;
+  p[2] = (v >> 8) & 0xff;
+  p[3] = v & 0xff;
+}
+
+PngWriter::PngWriter(Glib::ustring filename, guint32 width, guint32 height)
+ : d_out(filename.c_str(), std::ios::out | std::ios::binary),
+    d_width(width), d_height(height), d_rows_written(0), d_broken(false),
+    d_closed(false), d_row(1 + width * 4), d_idat(IDAT_SIZE)
+{
+  memset(&d_zstream, 0, sizeof (d_zstream));
+  if (!d_out || width == 0 || height == 0 ||
+      deflateInit(&d_zstream, Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+      d_broken = true;
+      d_closed = true;
+      return;
+    }
+  d_zstream.next_out = &d_idat[0];
+  d_zstream.avail_out = d_idat.size();
+
+  static const unsigned char signature[8] =
+    {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  d_out.write((const char*)signature, sizeof (signature));
+
+  unsigned char ihdr[13];
+  put_u32(ihdr, width);
+  put_u32(ihdr + 4, height);
+  ihdr[8] = 8; // bits per channel
+  ihdr[9] = 6; // rgba
+  ihdr[10] = 0; // deflate
+  ihdr[11] = 0; // adaptive filtering
+  ihdr[12] = 0; // not interlaced
+  write_chunk("IHDR", ihdr, sizeof (ihdr));
+}
+
+PngWriter::~PngWriter()
+{
+  if (!d_closed)
+    deflateEnd(&d_zstream);
+}
+
+void PngWriter::write_chunk(const char *type, const unsigned char *data,
+                            guint32 len)
+{
+  unsigned char buf[4];
+  put_u32(buf, len);
+  d_out.write((const char*)buf, 4);
+  d_out.write(type, 4);
+  if (len)
+    d_out.write((const char*)data, len);
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, (const Bytef*)type, 4);
+  if (len)
+    crc = crc32(crc, data, len);
+  put_u32(buf, crc);
+  d_out.write((const char*)buf, 4);
+  if (!d_out)
+    d_broken = true;
+}
+
+bool PngWriter::compress(const unsigned char *data, guint32 len, int flush)
+{
+  d_zstream.next_in = const_cast<unsigned char*>(data);
+  d_zstream.avail_in = len;
+  while (true)
+    {
+      int ret = deflate(&d_zstream, flush);
+      if (ret == Z_STREAM_ERROR)
+        return false;
+      if (d_zstream.avail_out == 0)
+        {
+          write_chunk("IDAT", &d_idat[0], d_idat.size());
+          d_zstream.next_out = &d_idat[0];
+          d_zstream.avail_out = d_idat.size();
+          continue;
+        }
+      if (flush == Z_FINISH)
+        {
+          if (ret == Z_STREAM_END)
+            break;
+        }
+      else if (d_zstream.avail_in == 0)
+        break;
+    }
+  return !d_broken;
+}
+
+bool PngWriter::write(const unsigned char *data, int stride, guint32 rows)
+{
+  if (d_broken || d_closed)
+    return false;
+  if (d_rows_written + rows > d_height)
+    {
+      d_broken = true;
+      return false;
+    }
+  for (guint32 j = 0; j < rows; j++)
+    {
+      const guint32 *src = (const guint32*)(data + j * stride);
+      unsigned char *dst = &d_row[0];
+      *dst++ = 0; // no filter
+      for (guint32 i = 0; i < d_width; i++)
+        {
+          guint32 p = src[i];
+          guint32 a = p >> 24;
+          if (a == 0)
+            {
+              memset(dst, 0, 4);
+              dst += 4;
+              continue;
+            }
+          // undo the premultiplication
+          *dst++ = (((p >> 16) & 0xff) * 255 + a / 2) / a;
+          *dst++ = (((p >> 8) & 0xff) * 255 + a / 2) / a;
+          *dst++ = ((p & 0xff) * 255 + a / 2) / a;
+          *dst++ = a;
+        }
+      if (!compress(&d_row[0], d_row.size(), Z_NO_FLUSH))
+        {
+          d_broken = true;
+          return false;
+        }
+    }
+  d_rows_written += rows;
+  return true;
+}
+
+bool PngWriter::close()
+{
+  if (d_closed)
+    return !d_broken;
+  if (d_rows_written != d_height)
+    d_broken = true;
+  if (!d_broken && compress(NULL, 0, Z_FINISH))
+    {
+      guint32 left = d_idat.size() - d_zstream.avail_out;
+      if (left)
+        write_chunk("IDAT", &d_idat[0], left);
+      write_chunk("IEND", NULL, 0);
+    }
+  else
+    d_broken = true;
+  deflateEnd(&d_zstream);
+  d_closed = true;
+  d_out.close();
+  return !d_broken;
+}
@@ -0,0 +1,83 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#pragma once
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <fstream>
+#include <vector>
+#include <zlib.h>
+#include <glibmm.h>
+
+//! Writes a png file a few rows at a time.
+/**
+ * The rows are compressed and written out as they are handed over, so
+ * an image of any size can be written while only holding onto a band of
+ * its rows.
+ *
+ * The rows are in Cairo's ARGB32 format, which is premultiplied, and they
+ * are written out as 8 bit RGBA.
+ */
+class PngWriter
+{
+ public:
+    //! Make a new png file with the given size, and write out its header.
+    PngWriter(Glib::ustring filename, guint32 width, guint32 height);
+
+    //! Destructor.
+    ~PngWriter();
+
+    //! Add rows to the bottom of the image.
+    /**
+     * @param data    The first pixel of the first row.
+     * @param stride  The number of bytes from one row to the next.
+     * @param rows    How many rows to add.
+     *
+     * @return false if something went wrong.
+     */
+    bool write(const unsigned char *data, int stride, guint32 rows);
+
+    //! Finish the file after all of the rows have been written.
+    /**
+     * @return false if something went wrong, or rows are missing.
+     */
+    bool close();
+
+    //! Returns whether or not something has gone wrong.
+    bool isBroken() const {return d_broken;}
+
+ private:
+    void write_chunk(const char *type, const unsigned char *data, guint32 len);
+    bool compress(const unsigned char *data, guint32 len, int flush);
+
+    std::ofstream d_out;
+    z_stream d_zstream;
+    guint32 d_width;
+    guint32 d_height;
+    guint32 d_rows_written;
+    bool d_broken;
+    bool d_closed;
+
+    //! One row of RGBA pixels with its filter byte.
+    std::vector<unsigned char> d_row;
+
+    //! Compressed data waiting to go out in an IDAT chunk.
+    std::vector<unsigned char> d_idat;
+};
+
+#endif // PNG_WRITER_H
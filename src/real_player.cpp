@@ -60,13 +60,13 @@ RealPlayer::RealPlayer(XML_Helper* helper)
 {
 }
 
-bool RealPlayer::save(XML_Helper* helper) const
+bool RealPlayer::save(XML_Helper* helper, guint32 skip_history) const
 {
     // This may seem a bit dumb, but allows derived players (especially
     // AI's) to save additional data, such as character types or so.
     bool retval = true;
     retval &= helper->openTag(Player::d_tag);
-    retval &= Player::save(helper);
+    retval &= Player::save(helper, skip_history);
     retval &= helper->closeTag();
 
     return retval;
@@ -66,7 +66,7 @@ class RealPlayer : public Player
 
 	virtual bool isComputer() const {return false;};
 
-        virtual bool save(XML_Helper* helper) const;
+        virtual bool save(XML_Helper* helper, guint32 skip_history = 0) const;
 
 	virtual void abortTurn();
 
@@ -93,4 +93,16 @@ inline bool is_inside(const LwRectangle &r, Vector<int> v)
 	&& r.y <= v.y && v.y < r.y + r.h;
 }
 
+//! Return the overlapping part of two rectangles, which might be empty.
+inline LwRectangle intersect(const LwRectangle &a, const LwRectangle &b)
+{
+    int x1 = a.x > b.x ? a.x : b.x;
+    int y1 = a.y > b.y ? a.y : b.y;
+    int x2 = a.x + a.w < b.x + b.w ? a.x + a.w : b.x + b.w;
+    int y2 = a.y + a.h < b.y + b.h ? a.y + a.h : b.y + b.h;
+    if (x2 <= x1 || y2 <= y1)
+      return LwRectangle(x1, y1, 0, 0);
+    return LwRectangle(x1, y1, x2 - x1, y2 - y1);
+}
+
 #endif
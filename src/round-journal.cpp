@@ -0,0 +1,409 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#include <fstream>
+#include <sstream>
+#include <sigc++/functors/mem_fun.h>
+
+#include "round-journal.h"
+#include "game-actionlist.h"
+#include "playerlist.h"
+#include "player.h"
+#include "history.h"
+#include "xmlhelper.h"
+#include "File.h"
+#include "ucompose.hpp"
+#include "defs.h"
+
+Glib::ustring RoundJournal::d_tag = "journal";
+Glib::ustring RoundJournal::d_record_tag = "round";
+Glib::ustring RoundJournal::d_history_tag = "histories";
+//#define debug(x) {std::cerr<<__FILE__<<": "<<__LINE__<<": "<<x<<std::endl<<std::flush;}
+#define debug(x)
+
+//! The journal gets rewritten as one record when it has this many.
+#define JOURNAL_COMPACT_RECORDS 25
+
+RoundJournal* RoundJournal::s_instance = 0;
+
+//! Picks the turns and the players' histories out of a record of the journal.
+class RoundRecordLoader
+{
+public:
+    RoundRecordLoader() : first(0), player_id(0) {}
+    ~RoundRecordLoader()
+      {
+        for (auto t: turns)
+          delete t;
+        for (auto &h: histories)
+          for (auto e: h.second)
+            delete e;
+      }
+
+    bool load(Glib::ustring tag, XML_Helper* helper)
+      {
+        if (tag == RoundJournal::d_record_tag)
+          {
+            helper->getData(id, "id");
+            helper->getData(first, "first");
+            return true;
+          }
+        if (tag == TurnActionlist::d_tag)
+          {
+            turns.push_back(new TurnActionlist(helper));
+            return true;
+          }
+        if (tag == RoundJournal::d_history_tag)
+          {
+            guint32 first_history = 0;
+            helper->getData(player_id, "player");
+            helper->getData(first_history, "first");
+            first_histories[player_id] = first_history;
+            return true;
+          }
+        if (tag == History::d_tag)
+          {
+            History *history = History::handle_load(helper);
+            if (!history)
+              return false;
+            histories[player_id].push_back(history);
+            return true;
+          }
+        return false;
+      }
+
+    Glib::ustring id;
+    guint32 first;
+    std::list<TurnActionlist*> turns;
+    guint32 player_id;
+    std::map<guint32, guint32> first_histories;
+    std::map<guint32, std::list<History*> > histories;
+};
+
+Glib::ustring RoundJournal::getFilename(Glib::ustring savefile)
+{
+  return File::add_slash_if_necessary(File::get_dirname(savefile)) +
+    File::get_basename(savefile) + JOURNAL_EXT;
+}
+
+RoundJournal* RoundJournal::getInstance()
+{
+  if (s_instance == NULL)
+    s_instance = new RoundJournal();
+
+  return s_instance;
+}
+
+RoundJournal* RoundJournal::getInstance(XML_Helper* helper)
+{
+  if (s_instance)
+    deleteInstance();
+
+  s_instance = new RoundJournal(helper);
+  return s_instance;
+}
+
+void RoundJournal::deleteInstance()
+{
+  if (s_instance)
+    delete s_instance;
+
+  s_instance = NULL;
+}
+
+RoundJournal::RoundJournal()
+ : d_id(""), d_turns(0), d_records(0)
+{
+}
+
+RoundJournal::RoundJournal(XML_Helper* helper)
+ : d_id(""), d_turns(0), d_records(0)
+{
+  helper->getData(d_id, "id");
+  helper->getData(d_turns, "turns");
+
+  // the histories are a player id and a count of events, for each player.
+  Glib::ustring histories;
+  helper->getData(histories, "histories");
+  std::stringstream shistories;
+  shistories.str(histories);
+  guint32 player_id, count;
+  while (shistories >> player_id >> count)
+    d_histories[player_id] = count;
+}
+
+guint32 RoundJournal::getHistories(guint32 player_id) const
+{
+  return getCount(d_histories, player_id);
+}
+
+bool RoundJournal::isEmpty() const
+{
+  if (d_turns > 0)
+    return false;
+  for (auto h: d_histories)
+    if (h.second > 0)
+      return false;
+  return true;
+}
+
+guint32 RoundJournal::getCount(const std::map<guint32, guint32> &counts,
+                               guint32 player_id)
+{
+  std::map<guint32, guint32>::const_iterator it = counts.find(player_id);
+  if (it == counts.end())
+    return 0;
+  return (*it).second;
+}
+
+void RoundJournal::countHistories(std::map<guint32, guint32> &counts)
+{
+  counts.clear();
+  for (auto p: *Playerlist::getInstance())
+    counts[p->getId()] = p->getHistorylist()->size();
+}
+
+bool RoundJournal::save(XML_Helper* helper) const
+{
+  bool retval = true;
+
+  retval &= helper->openTag(RoundJournal::d_tag);
+  retval &= helper->saveData("id", d_id);
+  retval &= helper->saveData("turns", d_turns);
+  std::stringstream histories;
+  for (auto h: d_histories)
+    histories << h.first << " " << h.second << " ";
+  retval &= helper->saveData("histories", histories.str());
+  retval &= helper->closeTag();
+
+  return retval;
+}
+
+bool RoundJournal::writeRecord(std::ostream &out, Glib::ustring id,
+                               guint32 first,
+                               const std::map<guint32, guint32> &first_histories)
+{
+  std::ostringstream os;
+  XML_Helper helper(&os, true);
+  bool retval = true;
+  retval &= helper.begin(LORDSAWAR_SAVEGAME_VERSION);
+  retval &= helper.openTag(RoundJournal::d_record_tag);
+  retval &= helper.saveData("id", id);
+  retval &= helper.saveData("first", first);
+  guint32 i = 0;
+  for (auto turn: *GameActionlist::getInstance())
+    if (i++ >= first)
+      retval &= turn->save(&helper);
+  for (auto p: *Playerlist::getInstance())
+    {
+      guint32 first_history = getCount(first_histories, p->getId());
+      std::list<History*> *histories = p->getHistorylist();
+      if (histories->size() <= first_history)
+        continue;
+      retval &= helper.openTag(RoundJournal::d_history_tag);
+      retval &= helper.saveData("player", p->getId());
+      retval &= helper.saveData("first", first_history);
+      i = 0;
+      for (auto history: *histories)
+        if (i++ >= first_history)
+          retval &= history->save(&helper);
+      retval &= helper.closeTag();
+    }
+  retval &= helper.closeTag();
+  helper.close();
+  if (!retval)
+    return false;
+
+  // each record is its length, and then the document.
+  std::string record = os.str();
+  guint32 len = record.size();
+  unsigned char buf[4];
+  buf[0] = (len >> 24) & 0xff;
+  buf[1] = (len >> 16) & 0xff;
+  buf[2] = (len >> 8) & 0xff;
+  buf[3] = len & 0xff;
+  out.write((const char*)buf, 4);
+  out.write(record.data(), record.size());
+  return out.good();
+}
+
+bool RoundJournal::readRecord(std::istream &in, std::string &record)
+{
+  unsigned char buf[4];
+  in.read((char*)buf, 4);
+  if (in.gcount() != 4)
+    return false;
+  guint32 len = (guint32(buf[0]) << 24) | (guint32(buf[1]) << 16) |
+    (guint32(buf[2]) << 8) | guint32(buf[3]);
+  record.resize(len);
+  if (len)
+    in.read(&record[0], len);
+  // the last record can be cut short if the game stopped while writing it.
+  return guint32(in.gcount()) == len;
+}
+
+bool RoundJournal::compact(Glib::ustring filename, Glib::ustring id)
+{
+  d_records = 0;
+  Glib::ustring tmpfile = File::get_tmp_file();
+  std::ofstream out(tmpfile.c_str(),
+                    std::ios::out | std::ios::trunc | std::ios::binary);
+  bool retval = writeRecord(out, id, 0, std::map<guint32, guint32>());
+  out.close();
+  if (retval && !out.fail())
+    {
+      File::erase(filename);
+      retval = File::rename(tmpfile, filename);
+    }
+  else
+    retval = false;
+  if (!retval)
+    {
+      std::cerr << String::ucompose(_("Couldn't write the round journal `%1'."), filename) << std::endl;
+      File::erase(tmpfile);
+      return false;
+    }
+  d_id = id;
+  d_turns = GameActionlist::getInstance()->size();
+  countHistories(d_histories);
+  d_records = 1;
+  return true;
+}
+
+bool RoundJournal::append(Glib::ustring filename, Glib::ustring id)
+{
+  guint32 turns = GameActionlist::getInstance()->size();
+  std::map<guint32, guint32> histories;
+  countHistories(histories);
+  // a history that got shorter can't be added onto.
+  bool shrunk = d_turns > turns;
+  for (auto h: d_histories)
+    if (getCount(histories, h.first) < h.second)
+      shrunk = true;
+  if (d_id != id || d_records == 0 || d_records >= JOURNAL_COMPACT_RECORDS ||
+      shrunk || File::exists(filename) == false)
+    return compact(filename, id);
+
+  if (d_turns == turns && d_histories == histories)
+    return true;
+
+  debug("appending turns " << d_turns << " to " << turns << " to " << filename);
+  std::ofstream out(filename.c_str(),
+                    std::ios::out | std::ios::app | std::ios::binary);
+  bool retval = writeRecord(out, id, d_turns, d_histories);
+  out.close();
+  if (!retval || out.fail())
+    {
+      // a record that is cut short can't be added onto.
+      d_records = 0;
+      std::cerr << String::ucompose(_("Couldn't write the round journal `%1'."), filename) << std::endl;
+      return false;
+    }
+  d_turns = turns;
+  d_histories = histories;
+  d_records++;
+  return true;
+}
+
+bool RoundJournal::load(Glib::ustring filename)
+{
+  std::list<TurnActionlist*> turns;
+  std::map<guint32, std::list<History*> > histories;
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  std::string record;
+  d_records = 0;
+  bool complete = true;
+  while (in && readRecord(in, record))
+    {
+      std::istringstream is(record);
+      RoundRecordLoader loader;
+      XML_Helper helper(&is);
+      helper.registerTag(d_record_tag,
+                         sigc::mem_fun(loader, &RoundRecordLoader::load));
+      helper.registerTag(TurnActionlist::d_tag,
+                         sigc::mem_fun(loader, &RoundRecordLoader::load));
+      helper.registerTag(d_history_tag,
+                         sigc::mem_fun(loader, &RoundRecordLoader::load));
+      helper.registerTag(History::d_tag,
+                         sigc::mem_fun(loader, &RoundRecordLoader::load));
+      bool loaded = helper.parseXML();
+      helper.close();
+      if (loaded)
+        for (auto h: loader.first_histories)
+          if (h.second != histories[h.first].size())
+            loaded = false;
+      if (!loaded || loader.id != d_id || loader.first != turns.size())
+        {
+          complete = false;
+          break;
+        }
+      turns.splice(turns.end(), loader.turns);
+      for (auto &h: loader.histories)
+        histories[h.first].splice(histories[h.first].end(), h.second);
+      d_records++;
+    }
+
+  // an autosave that didn't get finished leaves turns that nobody asked for.
+  if (in.peek() != std::char_traits<char>::eof())
+    complete = false;
+  while (turns.size() > d_turns)
+    {
+      delete turns.back();
+      turns.pop_back();
+      complete = false;
+    }
+  bool missing = turns.size() < d_turns;
+  for (auto &h: histories)
+    {
+      guint32 count = getHistories(h.first);
+      while (h.second.size() > count)
+        {
+          delete h.second.back();
+          h.second.pop_back();
+          complete = false;
+        }
+    }
+  for (auto h: d_histories)
+    if (histories[h.first].size() < h.second)
+      missing = true;
+
+  GameActionlist *actions = GameActionlist::getInstance();
+  actions->insert(actions->begin(), turns.begin(), turns.end());
+  for (auto &h: histories)
+    {
+      Player *p = Playerlist::getInstance()->getPlayer(h.first);
+      if (p)
+        p->getHistorylist()->splice(p->getHistorylist()->begin(), h.second);
+      else if (h.second.empty() == false)
+        {
+          for (auto e: h.second)
+            delete e;
+          missing = true;
+        }
+    }
+
+  // the next autosave rewrites a journal that has more in it than we read,
+  // instead of adding onto the end of it.
+  if (!complete)
+    d_records = 0;
+  if (missing)
+    {
+      std::cerr << String::ucompose(_("The round journal `%1' is missing some of the game."), filename) << std::endl;
+      return false;
+    }
+  return true;
+}
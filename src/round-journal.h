@@ -0,0 +1,166 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#pragma once
+#ifndef ROUND_JOURNAL_H
+#define ROUND_JOURNAL_H
+
+#include <iostream>
+#include <map>
+#include <glibmm.h>
+
+class XML_Helper;
+
+//! Keeps the turns and histories of a game in a file beside the autosave.
+/**
+ * The GameActionlist gets a TurnActionlist for every turn that is played,
+ * and each Player gets History events as the game goes on, and neither of
+ * them ever gets shorter.  Writing all of it into every autosave makes each
+ * autosave slower than the last, so the autosave keeps them in a journal
+ * file instead.  Each autosave adds a record holding the turns and the
+ * History events since the last autosave onto the end of the journal, and
+ * the autosave itself only says how many of them the journal holds for it.
+ *
+ * Every so often the journal gets rewritten as a single record, so that it
+ * doesn't take long to read back.
+ *
+ * The autosave can't be loaded without its journal, so the journal has to
+ * be moved or copied along with it.
+ *
+ * The journal is written before the autosave is, so when an autosave doesn't
+ * get finished the journal can hold more turns than the last autosave knows
+ * about.  Only as many as the autosave asks for are read back.
+ *
+ * This object is equivalent to a <journal> object in the saved-game file.
+ *
+ * Implemented as a singleton.
+ */
+class RoundJournal
+{
+    public:
+	//! The xml tag of this object in a saved-game file.
+	static Glib::ustring d_tag;
+
+	//! The xml tag of a record in the journal file.
+	static Glib::ustring d_record_tag;
+
+	//! The xml tag of a player's History events in a record.
+	static Glib::ustring d_history_tag;
+
+        //! Returns the name of the journal file kept beside a saved-game file.
+        static Glib::ustring getFilename(Glib::ustring savefile);
+
+        //! Gets the singleton instance or creates a new one.
+        static RoundJournal * getInstance();
+
+        //! Loads the RoundJournal from a saved-game file.
+        static RoundJournal * getInstance(XML_Helper* helper);
+
+        //! Explicitly deletes the singleton instance.
+        static void deleteInstance();
+
+        //! Save which journal the saved-game file uses, and how much of it.
+        bool save(XML_Helper* helper) const;
+
+        //! Returns how many turns at the front of the GameActionlist are
+        //! kept in the journal.
+        guint32 getTurns() const {return d_turns;}
+
+        //! Returns how many History events at the front of the given
+        //! player's history are kept in the journal.
+        guint32 getHistories(guint32 player_id) const;
+
+        //! Returns whether the journal keeps nothing for the saved-game file.
+        bool isEmpty() const;
+
+        //! Add the turns and History events that aren't in the journal yet
+        //! onto the end of it.
+        /**
+         * The journal gets rewritten instead when it belongs to another
+         * game, when it has enough records in it, or when the game has
+         * fewer turns or History events than the journal does.
+         *
+         * @param filename   The journal file.
+         * @param id         The id of the scenario being played.
+         *
+         * @return false if the journal couldn't be written, in which case
+         *         the saved-game file has to have all of the turns and
+         *         History events in it.
+         */
+        bool append(Glib::ustring filename, Glib::ustring id);
+
+        //! Read the journaled turns into the front of the GameActionlist,
+        //! and the journaled History events into the front of each Player's.
+        /**
+         * The next autosave rewrites the journal after this when the journal
+         * had more in it than was read, or when it was damaged.
+         *
+         * @return false if the journal didn't have all of the turns and
+         *         History events that the saved-game file asked for.
+         */
+        bool load(Glib::ustring filename);
+
+    protected:
+	//! Default constructor.
+        RoundJournal();
+
+	//! Loading constructor.
+        RoundJournal(XML_Helper* helper);
+
+	//! Destructor.
+        ~RoundJournal() {};
+
+    private:
+        //! Rewrite the journal as one record holding all of the turns and
+        //! History events.
+        bool compact(Glib::ustring filename, Glib::ustring id);
+
+        //! Write a record of the turns from the given one onwards, and of
+        //! each player's History events from the given one onwards.
+        static bool writeRecord(std::ostream &out, Glib::ustring id,
+                                guint32 first,
+                                const std::map<guint32, guint32> &first_histories);
+
+        //! Get the count kept for a player, or 0 if there isn't one.
+        static guint32 getCount(const std::map<guint32, guint32> &counts,
+                                guint32 player_id);
+
+        //! Count the History events that each player has.
+        static void countHistories(std::map<guint32, guint32> &counts);
+
+        //! Read the next record out of the journal.
+        static bool readRecord(std::istream &in, std::string &record);
+
+        // DATA
+
+        //! The id of the scenario that the journal belongs to.
+        Glib::ustring d_id;
+
+        //! How many turns are kept in the journal.
+        guint32 d_turns;
+
+        //! How many History events are kept in the journal, by player id.
+        std::map<guint32, guint32> d_histories;
+
+        //! How many records are in the journal, or 0 if it needs rewriting.
+        guint32 d_records;
+
+        //! A static pointer for the singleton instance.
+        static RoundJournal * s_instance;
+};
+
+#endif // ROUND_JOURNAL_H
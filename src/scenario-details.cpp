@@ -17,20 +17,25 @@
 
 #include <fstream>
 #include <sstream>
+#include <glib/gstdio.h>
 #include "scenario-details.h"
 #include "GameScenario.h"
+#include "xmlhelper.h"
+
+Glib::ustring ScenarioDetails::d_tag = "scenario";
 
 ScenarioDetails::ScenarioDetails(Glib::ustring id, guint32 num_cities, 
                                  guint32 num_players, Glib::ustring name,
                                  Glib::ustring desc, Glib::ustring filename)
 : d_id(id), d_number_of_cities(num_cities), d_number_of_players(num_players),
-    d_name(name), d_desc (desc), d_filename(filename)
+    d_name(name), d_desc (desc), d_filename(filename), d_mtime(0), d_size(0)
 {
 }
 
 ScenarioDetails::ScenarioDetails (Glib::ustring filename, bool &broken)
- : d_filename (filename)
+ : d_filename (filename), d_mtime(0), d_size(0)
 {
+  readStamp(filename, d_mtime, d_size);
   guint32 player_count, city_count;
   Glib::ustring id, comment, name;
   GameScenario::loadDetails(filename, broken, player_count, city_count, name, comment, id);
@@ -43,3 +48,51 @@ ScenarioDetails::ScenarioDetails (Glib::ustring filename, bool &broken)
       d_desc = comment;
     }
 }
+
+ScenarioDetails::ScenarioDetails (XML_Helper *helper)
+ : d_number_of_cities(0), d_number_of_players(0), d_mtime(0), d_size(0)
+{
+  helper->getData(d_filename, "filename");
+  helper->getData(d_mtime, "mtime");
+  helper->getData(d_size, "size");
+  helper->getData(d_id, "id");
+  helper->getData(d_name, "name");
+  helper->getData(d_desc, "comment");
+  helper->getData(d_number_of_cities, "cities");
+  helper->getData(d_number_of_players, "players");
+}
+
+bool ScenarioDetails::save(XML_Helper *helper) const
+{
+  bool retval = true;
+  retval &= helper->openTag(ScenarioDetails::d_tag);
+  retval &= helper->saveData("filename", d_filename);
+  retval &= helper->saveData("mtime", d_mtime);
+  retval &= helper->saveData("size", d_size);
+  retval &= helper->saveData("id", d_id);
+  retval &= helper->saveData("name", d_name);
+  retval &= helper->saveData("comment", d_desc);
+  retval &= helper->saveData("cities", d_number_of_cities);
+  retval &= helper->saveData("players", d_number_of_players);
+  retval &= helper->closeTag();
+  return retval;
+}
+
+bool ScenarioDetails::isStale() const
+{
+  guint32 mtime = 0, size = 0;
+  if (readStamp(d_filename, mtime, size) == false)
+    return true;
+  return mtime != d_mtime || size != d_size;
+}
+
+bool ScenarioDetails::readStamp(Glib::ustring filename, guint32 &mtime,
+                                guint32 &size)
+{
+  GStatBuf buf;
+  if (g_stat(filename.c_str(), &buf) != 0)
+    return false;
+  mtime = buf.st_mtime;
+  size = buf.st_size;
+  return true;
+}
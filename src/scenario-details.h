@@ -26,10 +26,15 @@
 
 #include "GameScenario.h"
 
+class XML_Helper;
+
 //! A single entry in the scenario list.
 /**
  * Holds the name, id, etc of the scenario along with the filename.
- * It's similar to a RecentlyPlayedGame object but there's no backing store.
+ * It's similar to a RecentlyPlayedGame object.  The details get kept in the
+ * scenario cache file, along with the modification time and size of the map
+ * file they were read from, so that they can be shown without opening up
+ * the map file again.
  *
  */
 class ScenarioDetails
@@ -49,6 +54,13 @@ class ScenarioDetails
          */
         ScenarioDetails (Glib::ustring filename, bool &broken);
 
+        //! Loading constructor.
+        /**
+         * Make a new ScenarioDetails object from an opened scenario cache
+         * file.
+         */
+        ScenarioDetails (XML_Helper *helper);
+
 	//! Destructor.
         ~ScenarioDetails() {}
 
@@ -72,6 +84,15 @@ class ScenarioDetails
 	//! Get the name of the scenario.
 	Glib::ustring getFilename() const {return d_filename;}
 
+        //! Whether the map file has changed since the details were read.
+        bool isStale() const;
+
+        //! Save the details to an opened scenario cache file.
+        bool save(XML_Helper *helper) const;
+
+        //! The name of the xml tag of this object in the scenario cache.
+        static Glib::ustring d_tag;
+
     protected:
 
 	// DATA
@@ -93,6 +114,18 @@ class ScenarioDetails
 
 	//! The filename of the map.
 	Glib::ustring d_filename;
+
+        //! The modification time of the map file when it was read.
+        guint32 d_mtime;
+
+        //! The size of the map file when it was read.
+        guint32 d_size;
+
+    private:
+
+        //! Get the modification time and size of a file.
+        static bool readStamp(Glib::ustring filename, guint32 &mtime,
+                              guint32 &size);
 };
 
 #endif // SCENARIO_DETAILS_H
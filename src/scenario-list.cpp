@@ -17,12 +17,18 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <fstream>
 #include <sigc++/functors/mem_fun.h>
 
 #include "scenario-list.h"
 #include "scenario-details.h"
+#include "xmlhelper.h"
+#include "defs.h"
 #include "File.h"
 
+//! The file in the cache directory that holds the details of the maps.
+#define SCENARIO_CACHE_FILE "scenarios.xml"
+
 ScenarioList* ScenarioList::s_instance = 0;
 
 ScenarioList* ScenarioList::getInstance()
@@ -42,29 +48,148 @@ void ScenarioList::deleteInstance()
 }
 
 ScenarioList::ScenarioList()
+ : d_dirty(false)
 {
-  bool broken;
+  std::map<Glib::ustring, ScenarioDetails*> cached;
+  loadCache (cached);
+
+  std::list<Glib::ustring> files;
   for (auto i : File::scanMaps ())
+    files.push_back (File::getMapFile (i));
+  for (auto i : File::scanUserMaps())
+    files.push_back (File::getUserMapFile (i));
+
+  bool broken;
+  for (auto f : files)
     {
+      auto it = cached.find (f);
+      if (it != cached.end ())
+        {
+          ScenarioDetails *scen = it->second;
+          cached.erase (it);
+          push_back (scen);
+          if (scen->isStale ())
+            d_stale.push_back (scen);
+          continue;
+        }
       broken = false;
-      ScenarioDetails *scen =
-        new ScenarioDetails (File::getMapFile (i), broken);
+      ScenarioDetails *scen = new ScenarioDetails (f, broken);
       if (!broken)
         push_back (scen);
       else
         delete scen;
+      d_dirty = true;
     }
-  for (auto i : File::scanUserMaps())
+
+  // maps that went away.
+  for (auto i : cached)
     {
-      broken = false;
-      ScenarioDetails *scen =
-        new ScenarioDetails (File::getUserMapFile(i), broken);
-      if (!broken)
-        push_back (scen);
+      delete i.second;
+      d_dirty = true;
+    }
+  sort (compare);
+
+  if (d_stale.empty () == false)
+    d_refresh = Glib::signal_idle ().connect
+      (sigc::mem_fun (*this, &ScenarioList::refresh_next));
+  else if (d_dirty)
+    {
+      saveCache ();
+      d_dirty = false;
+    }
+}
+
+void ScenarioList::loadCache (std::map<Glib::ustring, ScenarioDetails*> &cached)
+{
+  Glib::ustring filename =
+    Glib::build_filename (File::getCacheDir (), SCENARIO_CACHE_FILE);
+  if (File::exists (filename) == false)
+    return;
+  XML_Helper helper (filename, std::ios::in);
+  helper.registerTag (ScenarioDetails::d_tag,
+                      sigc::bind (sigc::mem_fun (this, &ScenarioList::load_tag),
+                                  &cached));
+  bool retval = helper.parseXML ();
+  helper.close ();
+  if (retval == false)
+    {
+      // we just read the maps again.
+      for (auto i : cached)
+        delete i.second;
+      cached.clear ();
+      File::erase (filename);
+    }
+}
+
+bool ScenarioList::load_tag (Glib::ustring tag, XML_Helper *helper,
+                             std::map<Glib::ustring, ScenarioDetails*> *cached)
+{
+  if (helper->getVersion () != LORDSAWAR_SCENARIO_CACHE_VERSION)
+    return false;
+  if (tag == ScenarioDetails::d_tag)
+    {
+      ScenarioDetails *scen = new ScenarioDetails (helper);
+      auto it = cached->find (scen->getFilename ());
+      if (it != cached->end ())
+        {
+          delete it->second;
+          it->second = scen;
+        }
       else
-        delete scen;
+        (*cached)[scen->getFilename ()] = scen;
+      return true;
     }
+  return false;
+}
+
+bool ScenarioList::saveCache () const
+{
+  Glib::ustring filename =
+    Glib::build_filename (File::getCacheDir (), SCENARIO_CACHE_FILE);
+  // not being able to write the cache isn't worth exiting over.
+  std::ofstream out (filename.c_str (), std::ios::out | std::ios::trunc);
+  if (!out)
+    return false;
+  bool retval = true;
+  XML_Helper helper (&out);
+  retval &= helper.begin (LORDSAWAR_SCENARIO_CACHE_VERSION);
+  retval &= helper.openTag ("scenariolist");
+  for (const_iterator it = begin (); it != end (); ++it)
+    retval &= (*it)->save (&helper);
+  retval &= helper.closeTag ();
+  helper.close ();
+  out.close ();
+  if (!out)
+    retval = false;
+  return retval;
+}
+
+bool ScenarioList::refresh_next ()
+{
+  if (d_stale.empty () == false)
+    {
+      ScenarioDetails *scen = d_stale.front ();
+      d_stale.pop_front ();
+      bool broken = false;
+      ScenarioDetails fresh (scen->getFilename (), broken);
+      // a map that can't be read anymore keeps its old details, and
+      // it gets tried again next time.
+      if (!broken)
+        {
+          *scen = fresh;
+          d_dirty = true;
+          details_refreshed.emit (scen);
+        }
+    }
+  if (d_stale.empty () == false)
+    return true;
   sort (compare);
+  if (d_dirty)
+    {
+      saveCache ();
+      d_dirty = false;
+    }
+  return false;
 }
 
 bool ScenarioList::compare(const ScenarioDetails *lhs, const ScenarioDetails *rhs)
@@ -74,6 +199,9 @@ bool ScenarioList::compare(const ScenarioDetails *lhs, const ScenarioDetails *rh
 
 ScenarioList::~ScenarioList()
 {
+  d_refresh.disconnect ();
+  if (d_dirty)
+    saveCache ();
   for (ScenarioList::iterator it = begin(); it != end(); ++it)
     delete *it;
 }
@@ -21,6 +21,7 @@
 
 #include <gtkmm.h>
 #include <list>
+#include <map>
 
 #include "scenario-details.h"
 
@@ -32,6 +33,11 @@
  * We use this list when presenting the list of maps we can load,
  * and for finding a unique map name in the editor.
  *
+ * The details are kept in a cache file in the cache directory, so that the
+ * map files don't have to be opened up every time.  The details of map
+ * files that changed since they were cached get shown right away, and
+ * then they get read again when the main loop is idle.
+ *
  * Implemented as a singleton.
  */
 class ScenarioList : public std::list<ScenarioDetails*>
@@ -64,6 +70,9 @@ class ScenarioList : public std::list<ScenarioDetails*>
         //! Our list is sorted by scenario name.
         static bool compare(const ScenarioDetails *l, const ScenarioDetails *r);
 
+        //! Emitted when the details of a scenario have been read again.
+        sigc::signal<void, ScenarioDetails*> details_refreshed;
+
     protected:
 
 	//! Default constructor.
@@ -74,8 +83,30 @@ class ScenarioList : public std::list<ScenarioDetails*>
 
     private:
 
+        //! Read in the scenario cache file, keyed by map filename.
+        void loadCache(std::map<Glib::ustring, ScenarioDetails*> &cached);
+
+        //! Callback for loading the scenario cache file.
+        bool load_tag(Glib::ustring tag, XML_Helper *helper,
+                      std::map<Glib::ustring, ScenarioDetails*> *cached);
+
+        //! Write out the scenario cache file.
+        bool saveCache() const;
+
+        //! Read the details of the next stale scenario again.
+        bool refresh_next();
+
 	// DATA
 
+        //! Scenarios in the list whose details are out of date.
+        std::list<ScenarioDetails*> d_stale;
+
+        //! Whether the cache file needs to be written out.
+        bool d_dirty;
+
+        //! The idle callback that reads the stale scenarios again.
+        sigc::connection d_refresh;
+
         //! A static pointer for the singleton instance.
         static ScenarioList* s_instance;
 };
@@ -20,18 +20,19 @@
 
 Set::Set(Glib::ustring ext, guint32 id, Glib::ustring name, guint32 ts)
   : TarFile("", "", ext), d_id(id), d_name(name), d_license(""), d_info(""),
-    d_tileSize(ts), d_scale (1.0)
+    d_tileSize(ts), d_scale (1.0), d_instantiated (false)
 {
 }
 
 Set::Set(const Set &s)
   : TarFile(s), d_id(s.d_id), d_name(s.d_name), d_license(s.d_license),
-    d_info(s.d_info), d_tileSize(s.d_tileSize), d_scale(s.d_scale)
+    d_info(s.d_info), d_tileSize(s.d_tileSize), d_scale(s.d_scale),
+    d_instantiated(false)
 {
 }
 
 Set::Set(Glib::ustring ext, XML_Helper* helper, Glib::ustring directory)
- :TarFile(directory, "", ext), d_scale(1.0)
+ :TarFile(directory, "", ext), d_scale(1.0), d_instantiated(false)
 {
   helper->getData(d_id, "id");
   helper->getData(d_name, "name");
@@ -89,8 +89,14 @@ public:
     //!Get the zoom level.
     double get_scale () const {return d_scale;};
 
+    //! Whether or not the images of this set have been loaded.
+    bool getInstantiated () const {return d_instantiated;};
+
     //!Set the zoom level.
     void set_scale (double d) {d_scale = d;};
+protected:
+    //! Keep track of whether the images of this set are loaded or not.
+    void setInstantiated (bool i) {d_instantiated = i;};
 private:
 
     //! The unique Id of this set.
@@ -132,6 +138,12 @@ private:
 
     //! The zoom level of tiles.  A number between 0 and 1.
     double d_scale;
+
+    //! Whether the images have been loaded.
+    /**
+     * Copies of a set don't count as having their images loaded.
+     */
+    bool d_instantiated;
 };
 
 #endif
@@ -130,6 +130,31 @@ public:
         return (*it).second;
       }
 
+    //! Load the images of a set, unless they're already loaded.
+    /**
+     * The sets in the list only hold what's in their configuration files
+     * until they get used, and then their images get loaded here.
+     *
+     * @return the set, or NULL if there isn't one with this id.
+     */
+    T *ensureImages(guint32 id, bool &broken) const
+      {
+        broken = false;
+        T *set = get(id);
+        if (set && set->getInstantiated() == false)
+          set->instantiateImages(true, broken);
+        return set;
+      }
+
+    T *ensureImages(Glib::ustring bname, bool &broken) const
+      {
+        broken = false;
+        T *set = get(bname);
+        if (set && set->getInstantiated() == false)
+          set->instantiateImages(true, broken);
+        return set;
+      }
+
     void add(T *set, Glib::ustring file)
       {
         Glib::ustring basename = File::get_basename(file);
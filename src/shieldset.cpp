@@ -633,6 +633,8 @@ void Shieldset::instantiateImages(bool scale, bool &broken)
         }
     }
   t.Close();
+  if (!broken)
+    setInstantiated (true);
 }
 
 void Shieldset::uninstantiateImages()
@@ -644,5 +646,6 @@ void Shieldset::uninstantiateImages()
       for (guint32 k = Tartan::LEFT; k <= Tartan::RIGHT; k++)
         (*i)->getTartanMaskedImage (Tartan::Type (k))->uninstantiateImages ();
     }
+  setInstantiated (false);
 }
 //End of file
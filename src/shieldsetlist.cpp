@@ -98,15 +98,6 @@ ShieldStyle *Shieldsetlist::getShield(guint32 shieldset, guint32 type, guint32 c
   return s->lookupShieldByTypeAndColor(type, color);
 }
 
-void Shieldsetlist::instantiateImages(bool &broken)
-{
-  broken = false;
-  for (iterator it = begin (); it != end (); ++it)
-    if (!broken)
-      if ((*it)->validate () == true)
-        (*it)->instantiateImages (true, broken);
-}
-
 void Shieldsetlist::uninstantiateImages()
 {
   for (iterator it = begin (); it != end (); ++it)
@@ -56,9 +56,6 @@ class Shieldsetlist : public SetList<Shieldset>, public sigc::trackable
 	//! Destroy all of the images associated with shieldsets in this list.
 	void uninstantiateImages();
 
-	//! Load all of the images associated with all of the shieldsets.
-	void instantiateImages(bool &broken);
-
         //! Get the image and mask of the leftmost tartan.
         TarFileMaskedImage *getTartan (guint32 shieldset, guint32 color, Tartan::Type) const;
 
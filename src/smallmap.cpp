@@ -29,6 +29,7 @@
 #include "GameScenarioOptions.h"
 #include "GameMap.h"
 #include "playerlist.h"
+#include "draw-stats.h"
 
 bool SmallMap::s_quick = false;
 
@@ -188,6 +189,7 @@ int SmallMap::slide (int x, int y)
 
 void SmallMap::slide_view(LwRectangle new_view)
 {
+  DrawStats::Timer timer(DrawStats::SMALLMAP_SLIDE_VIEW);
   if (view != new_view)
     {
       sliding = true;
@@ -0,0 +1,185 @@
+//  Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#pragma once
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+//! A sequence that keeps its first N elements inside the object itself.
+/**
+ * This container has the list-like interface that the game code uses on
+ * a Stack (push_back, erase, remove, sort, and so on), but holds its
+ * elements in an array.  The first N elements live inside the object, so
+ * copying, splitting or joining small sequences doesn't allocate.  When
+ * more than N elements are added, the elements are moved to the heap.
+ *
+ * Unlike a std::list, erasing or inserting an element invalidates the
+ * iterators that come after it.
+ */
+template <class T, unsigned int N> class SmallVector
+{
+ public:
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  //! Default constructor.
+  SmallVector()
+    : d_data(d_inline), d_size(0), d_capacity(N) {}
+
+  //! Copy constructor.
+  SmallVector(const SmallVector &other)
+    : d_data(d_inline), d_size(0), d_capacity(N)
+    {
+      reserve(other.d_size);
+      std::copy(other.begin(), other.end(), d_data);
+      d_size = other.d_size;
+    }
+
+  //! Assignment operator.
+  SmallVector &operator=(const SmallVector &other)
+    {
+      if (this != &other)
+        {
+          reserve(other.d_size);
+          std::copy(other.begin(), other.end(), d_data);
+          d_size = other.d_size;
+        }
+      return *this;
+    }
+
+  //! Destructor.
+  ~SmallVector()
+    {
+      if (d_data != d_inline)
+        delete [] d_data;
+    }
+
+  iterator begin() {return d_data;}
+  iterator end() {return d_data + d_size;}
+  const_iterator begin() const {return d_data;}
+  const_iterator end() const {return d_data + d_size;}
+  reverse_iterator rbegin() {return reverse_iterator(end());}
+  reverse_iterator rend() {return reverse_iterator(begin());}
+  const_reverse_iterator rbegin() const {return const_reverse_iterator(end());}
+  const_reverse_iterator rend() const {return const_reverse_iterator(begin());}
+
+  size_type size() const {return d_size;}
+  bool empty() const {return d_size == 0;}
+
+  reference front() {return d_data[0];}
+  const_reference front() const {return d_data[0];}
+  reference back() {return d_data[d_size - 1];}
+  const_reference back() const {return d_data[d_size - 1];}
+
+  void push_back(const T &value)
+    {
+      if (d_size == d_capacity)
+        {
+          //the value might be one of ours, so hold onto it.
+          T copy = value;
+          reserve(d_capacity * 2);
+          d_data[d_size++] = copy;
+        }
+      else
+        d_data[d_size++] = value;
+    }
+
+  void push_front(const T &value) {insert(begin(), value);}
+
+  void pop_back() {d_size--;}
+
+  void pop_front() {erase(begin());}
+
+  //! Insert a value before the given position.
+  iterator insert(iterator pos, const T &value)
+    {
+      size_type idx = pos - d_data;
+      T copy = value;
+      if (d_size == d_capacity)
+        reserve(d_capacity * 2);
+      std::copy_backward(d_data + idx, d_data + d_size, d_data + d_size + 1);
+      d_data[idx] = copy;
+      d_size++;
+      return d_data + idx;
+    }
+
+  //! Erase an element, and return the position of the one after it.
+  iterator erase(iterator pos) {return erase(pos, pos + 1);}
+
+  iterator erase(iterator first, iterator last)
+    {
+      std::copy(last, end(), first);
+      d_size -= last - first;
+      return first;
+    }
+
+  //! Erase every element that is equal to the given value.
+  void remove(const T &value)
+    {
+      T copy = value;
+      d_size = std::remove(begin(), end(), copy) - begin();
+    }
+
+  void clear() {d_size = 0;}
+
+  //! Sort the elements, keeping equal elements in their order like a list.
+  template <class Compare> void sort(Compare comp)
+    {
+      std::stable_sort(begin(), end(), comp);
+    }
+
+  void reverse() {std::reverse(begin(), end());}
+
+  //! Make room for at least n elements.
+  void reserve(size_type n)
+    {
+      if (n <= d_capacity)
+        return;
+      T *data = new T[n];
+      std::copy(begin(), end(), data);
+      if (d_data != d_inline)
+        delete [] d_data;
+      d_data = data;
+      d_capacity = n;
+    }
+
+ private:
+  //! Storage for the first N elements.
+  T d_inline[N];
+
+  //! Where the elements are; either d_inline or an array on the heap.
+  T *d_data;
+
+  //! How many elements there are.
+  size_type d_size;
+
+  //! How many elements fit in d_data.
+  size_type d_capacity;
+};
+
+#endif // SMALLVECTOR_H
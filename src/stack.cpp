@@ -49,22 +49,22 @@ Glib::ustring Stack::d_tag = "stack";
 
 Stack::Stack(Player* player, Vector<int> pos)
     : UniquelyIdentified(), Movable(pos), OwnerId(player), d_defending(false), 
-    d_parked(false), d_deleting(false)
+    d_parked(false), d_deleting(false), d_cached(0)
 {
     d_path = new Path();
 }
 
 Stack::Stack(guint32 id, Player* player, Vector<int> pos)
     : UniquelyIdentified(id), Movable(pos), OwnerId(player), 
-    d_defending(false), d_parked(false), d_deleting(false)
+    d_defending(false), d_parked(false), d_deleting(false), d_cached(0)
 {
     d_path = new Path();
 }
 
 Stack::Stack(const Stack& s, bool uniq)
-    : UniquelyIdentified(s, !uniq), Movable(s), OwnerId(s), std::list<Army*>(),
+    : UniquelyIdentified(s, !uniq), Movable(s), OwnerId(s), ArmyVector(),
     sigc::trackable(s), d_defending(s.d_defending), d_parked(s.d_parked), 
-    d_deleting(false)
+    d_deleting(false), d_cached(0)
 {
   d_unique = uniq;
   if (s.d_path == NULL)
@@ -84,7 +84,7 @@ Stack::Stack(const Stack& s, bool uniq)
 
 Stack::Stack(XML_Helper* helper)
   : UniquelyIdentified(helper), Movable(helper), OwnerId(helper), 
-    d_deleting(false)
+    d_deleting(false), d_cached(0)
 {
   helper->getData(d_defending, "defending");
   helper->getData(d_parked, "parked");
@@ -157,6 +157,7 @@ bool Stack::isMovingToOrFromAShip(Vector<int> dest, bool &on_ship) const
 
 void Stack::drainMovement()
 {
+  invalidateCache();
   for (Stack::iterator it = begin(); it != end(); ++it)
     (*it)->decrementMoves((*it)->getMoves());
 }
@@ -200,6 +201,8 @@ void Stack::moveToDest(Vector<int> dest, bool skipping)
         }
     }
 
+  invalidateCache();
+
   //update position and status
   smoving.emit(this);
   setPos(dest);
@@ -224,10 +227,8 @@ void Stack::deFog()
 // return the maximum moves of this stack by checking the moves of each army
 guint32 Stack::getMoves() const
 {
-  if (empty())
-    return 0;
-
-  assert(!empty());
+  if (d_cached & CACHED_MOVES)
+    return d_cached_moves;
 
   int min = -1;
 
@@ -239,9 +240,9 @@ guint32 Stack::getMoves() const
 	min = std::min(min, int((*it)->getMoves()));
     }
 
-  if (min <= -1)
-    return 0;
-  return min;
+  d_cached_moves = min <= -1 ? 0 : min;
+  d_cached |= CACHED_MOVES;
+  return d_cached_moves;
 }
 
 int Stack::getMinTileMoves() const
@@ -279,6 +280,7 @@ void Stack::decrementMoves(guint32 moves)
 {
   debug("decrement_moves()");
 
+  invalidateCache();
   for (iterator it = begin(); it != end(); ++it)
     (*it)->decrementMoves(moves);
 }
@@ -287,6 +289,7 @@ void Stack::incrementMoves(guint32 moves)
 {
   debug("increment_moves()");
 
+  invalidateCache();
   for (iterator it = begin(); it != end(); ++it)
     (*it)->incrementMoves(moves);
 }
@@ -300,7 +303,12 @@ void Stack::incrementMoves(guint32 moves)
 Army* Stack::getStrongestArmy() const
 {
   assert(!empty());
-  return getStrongestArmy(false);
+  if ((d_cached & CACHED_STRONGEST_ARMY) == 0)
+    {
+      d_cached_strongest_army = getStrongestArmy(false);
+      d_cached |= CACHED_STRONGEST_ARMY;
+    }
+  return d_cached_strongest_army;
 }
 
 Army* Stack::getStrongestHero() const
@@ -382,6 +390,7 @@ void Stack::getHeroes(std::vector<guint32>& dst) const
 
 int Stack::bless()
 {
+  invalidateCache();
   int count = 0;
   for (iterator it = begin(); it != end(); ++it)
     {
@@ -475,6 +484,7 @@ void Stack::payUpkeep(Player *p)
 
 void Stack::reset(bool recalculate_path)
 {
+  invalidateCache();
   guint32 movement_multiplier = 1;
 
   //count the number of items that double the movement in the stack.
@@ -600,6 +610,16 @@ Stack::iterator Stack::flErase(Stack::iterator object)
 }
 
 guint32 Stack::calculateMoveBonus() const
+{
+  if ((d_cached & CACHED_MOVE_BONUS) == 0)
+    {
+      d_cached_move_bonus = calculateMoveBonusUncached();
+      d_cached |= CACHED_MOVE_BONUS;
+    }
+  return d_cached_move_bonus;
+}
+
+guint32 Stack::calculateMoveBonusUncached() const
 {
   guint32 d_bonus = 0;
 
@@ -720,12 +740,19 @@ bool Stack::isFlying () const
  * a boat */
 bool Stack::hasShip () const
 {
+  if (d_cached & CACHED_SHIP)
+    return d_cached_ship;
+  d_cached_ship = false;
   for (Stack::const_iterator it = this->begin(); it != this->end(); ++it)
     {
       if ((*it)->getStat(Army::SHIP))
-	return true;
+        {
+          d_cached_ship = true;
+          break;
+        }
     }
-  return false;
+  d_cached |= CACHED_SHIP;
+  return d_cached_ship;
 }
 
 guint32 getFightOrder(std::list<guint32> values, guint32 value)
@@ -762,6 +789,7 @@ void Stack::sortByStrength(bool rev)
   sort(armyCompareStrength);
   if (rev)
     std::reverse(begin(), end());
+  invalidateCache();
 }
 
 void Stack::sortForViewing (bool rev)
@@ -769,6 +797,7 @@ void Stack::sortForViewing (bool rev)
   sort(armyCompareFightOrder);
   if (rev)
     std::reverse(begin(), end());
+  invalidateCache();
 }
 
 void Stack::setFortified(bool fortified)
@@ -927,27 +956,29 @@ guint32 Stack::getMaxLandMoves() const
 
   assert(!empty());
 
+  if (d_cached & CACHED_MAX_LAND_MOVES)
+    return d_cached_max_land_moves;
+
   //copy the stack, reset the moves and return the group moves
   Stack *copy = new Stack (*this);
   copy->getPath()->clear(); //this prevents triggering path recalc in reset
   copy->decrementMoves(copy->getMoves());
   copy->reset(false);
   guint32 moves = copy->getMoves();
-  if (isFlying() == true)
+  if (isFlying() == false)
     {
-      delete copy;
-      return moves;
+      //alright, we're not flying.  what would our group moves be if we
+      //were on land?  remove ship status from all army units
+      copy->decrementMoves(copy->getMoves());
+      for (Stack::iterator it = copy->begin(); it != copy->end(); ++it)
+        (*it)->setInShip(false);
+      copy->reset(false);
+      moves = copy->getMoves();
     }
-
-  //alright, we're not flying.  what would our group moves be if we were on land
-  //remove ship status from all army units
-  copy->decrementMoves(copy->getMoves());
-  for (Stack::iterator it = copy->begin(); it != copy->end(); ++it)
-    (*it)->setInShip(false);
-  copy->reset(false);
-
-  moves = copy->getMoves();
   delete copy;
+
+  d_cached_max_land_moves = moves;
+  d_cached |= CACHED_MAX_LAND_MOVES;
   return moves;
 }
 
@@ -958,30 +989,34 @@ guint32 Stack::getMaxBoatMoves() const
 
   assert(!empty());
 
+  if (d_cached & CACHED_MAX_BOAT_MOVES)
+    return d_cached_max_boat_moves;
+
   //copy the stack, reset the moves and return the group moves
   Stack *copy = new Stack (*this);
   copy->getPath()->clear(); //this prevents triggering path recalc in reset
   copy->reset();
   guint32 moves = copy->getMoves();
-  if (isFlying() == true)
-    {
-      delete copy;
-      return moves;
-    }
-  //alright, we're not flying.  what would our group moves be if we were on water?
-  copy->decrementMoves(copy->getMoves());
-	      
-  for (Stack::iterator it = copy->begin(); it != copy->end(); ++it)
+  if (isFlying() == false)
     {
-      if (((*it)->getStat(Army::MOVE_BONUS) & Tile::WATER) == 0)
-	(*it)->setInShip(true);
-      else
-	(*it)->setInShip(false);
-    }
-  copy->reset();
+      //alright, we're not flying.  what would our group moves be if we
+      //were on water?
+      copy->decrementMoves(copy->getMoves());
 
-  moves = copy->getMoves();
+      for (Stack::iterator it = copy->begin(); it != copy->end(); ++it)
+        {
+          if (((*it)->getStat(Army::MOVE_BONUS) & Tile::WATER) == 0)
+            (*it)->setInShip(true);
+          else
+            (*it)->setInShip(false);
+        }
+      copy->reset();
+      moves = copy->getMoves();
+    }
   delete copy;
+
+  d_cached_max_boat_moves = moves;
+  d_cached |= CACHED_MAX_BOAT_MOVES;
   return moves;
 }
 	
@@ -1307,6 +1342,7 @@ bool Stack::killArmyUnitsInBoats()
       if ((*it)->getHP() > 0)
         (*it)->setInShip(false); //we're being carried by a flyer
     }
+  invalidateCache();
   return retval;
 }
           
@@ -1353,6 +1389,7 @@ void Stack::updateShipStatus(Vector<int> dest)
 {
   bool to_water = (GameMap::getInstance()->getTile(dest)->getType() == Tile::WATER);
   bool to_bridge = (GameMap::getBridge(dest) != NULL);
+  invalidateCache();
   for (Stack::iterator it = begin(); it != end(); ++it)
     {
       if (to_water && !to_bridge && 
@@ -1374,18 +1411,17 @@ bool Stack::hasDeadArmies() const
 bool Stack::removeArmiesWithoutArmyType(guint32 armyset)
 {
   bool removedArmy = false;
-  for (iterator i = begin(); i != end(); ++i)
+  for (iterator i = begin(); i != end();)
     {
       Armyset *a = Armysetlist::getInstance()->get(armyset);
       ArmyProto *armyproto = a->lookupArmyByType((*i)->getTypeId());
       if (armyproto == NULL)
         {
           i = flErase(i);
-          if (size() > 0)
-            --i;
           removedArmy = true;
           continue;
         }
+      ++i;
     }
   return removedArmy;
 }
@@ -33,6 +33,8 @@
 #include "UniquelyIdentified.h"
 #include "OwnerId.h"
 #include "Movable.h"
+#include "smallvector.h"
+#include "defs.h"
 
 class Player;
 class Path;
@@ -41,6 +43,9 @@ class XML_Helper;
 class Hero;
 class Item;
 
+//! The container that holds the Army units of a Stack.
+typedef SmallVector<Army*, MAX_STACK_SIZE> ArmyVector;
+
 //! A set of up to eight Army units that move as a single entity on the map.
 /** 
  * While Army units are the actual troops you command, they always belong to a
@@ -48,9 +53,12 @@ class Item;
  * usually doesn't command the armies but the stack, so all functionality and
  * data which affects player's controls is bundled in the stack class. Among
  * this is the location of the units, the intended movement path, and more.
+ *
+ * The Army units are held in an ArmyVector, which keeps up to
+ * MAX_STACK_SIZE of them inside the stack itself.
  */
 
-class Stack : public ::UniquelyIdentified, public Movable, public OwnerId, public std::list<Army*>, public sigc::trackable
+class Stack : public ::UniquelyIdentified, public Movable, public OwnerId, public ArmyVector, public sigc::trackable
 {
     public:
 	//! The xml tag of this object in a saved-game file.
@@ -233,6 +241,34 @@ class Stack : public ::UniquelyIdentified, public Movable, public OwnerId, publi
 	 */
 	void add(Army *army);
 
+        //! Forget the cached values that summarize the Army units.
+        /**
+         * The stack notices when Army units are added, removed or moved,
+         * but this method must be called when an Army unit in the stack
+         * changes behind its back, e.g. when a Hero picks up an Item.
+         */
+        void invalidateCache() {d_cached = 0;}
+
+        // Methods of the list that change which Army units are in the stack.
+
+        void push_back(Army *army)
+          {invalidateCache(); ArmyVector::push_back(army);}
+        void push_front(Army *army)
+          {invalidateCache(); ArmyVector::push_front(army);}
+        void pop_back() {invalidateCache(); ArmyVector::pop_back();}
+        void pop_front() {invalidateCache(); ArmyVector::pop_front();}
+        iterator insert(iterator pos, Army *army)
+          {invalidateCache(); return ArmyVector::insert(pos, army);}
+        iterator erase(iterator it)
+          {invalidateCache(); return ArmyVector::erase(it);}
+        iterator erase(iterator first, iterator last)
+          {invalidateCache(); return ArmyVector::erase(first, last);}
+        void remove(Army *army)
+          {invalidateCache(); ArmyVector::remove(army);}
+        void clear() {invalidateCache(); ArmyVector::clear();}
+        template <class Compare> void sort(Compare comp)
+          {invalidateCache(); ArmyVector::sort(comp);}
+
 	//! Remove this stack's path.  Return true if anything was cleared.
 	bool clearPath();
 
@@ -500,6 +536,19 @@ static bool compareIds(const Army *lhs, const Army *rhs);
 	//! Helper method for returning strongest army.
 	Army* getStrongestArmy(bool hero) const;
 
+        //! Calculate the move bonus without looking at the cache.
+        guint32 calculateMoveBonusUncached() const;
+
+        //! The values that are cached in d_cached.
+        enum CachedValue {
+          CACHED_MOVES = 1,
+          CACHED_MOVE_BONUS = 2,
+          CACHED_SHIP = 4,
+          CACHED_MAX_LAND_MOVES = 8,
+          CACHED_MAX_BOAT_MOVES = 16,
+          CACHED_STRONGEST_ARMY = 32
+        };
+
         // DATA
 
 	//! The stack's intended path.
@@ -518,6 +567,32 @@ static bool compareIds(const Army *lhs, const Army *rhs);
 	 */
 	//! Whether or not this stack is in the midst of being deleted.
         bool d_deleting;
+
+	/**
+	 * The pathfinder, the AI and the renderer ask for the same values
+	 * over and over, so they are computed once and kept until something
+	 * changes the Army units in the stack.
+	 */
+	//! A bitwise OR-ing of the CachedValue values that are up to date.
+        mutable guint32 d_cached;
+
+	//! The cached value of getMoves.
+        mutable guint32 d_cached_moves;
+
+	//! The cached value of calculateMoveBonus.
+        mutable guint32 d_cached_move_bonus;
+
+	//! The cached value of hasShip.
+        mutable bool d_cached_ship;
+
+	//! The cached value of getMaxLandMoves.
+        mutable guint32 d_cached_max_land_moves;
+
+	//! The cached value of getMaxBoatMoves.
+        mutable guint32 d_cached_max_boat_moves;
+
+	//! The cached value of getStrongestArmy.
+        mutable Army *d_cached_strongest_army;
 };
 
 guint32 getFightOrder(std::list<guint32> values, guint32 value);
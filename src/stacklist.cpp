@@ -152,26 +152,34 @@ void Stacklist::nextTurn()
     //check();
 }
 
+//! Order stacks by position, column by column.
+static bool comparePos(const Stack *lhs, const Stack *rhs)
+{
+  if (lhs->getPos().x != rhs->getPos().x)
+    return lhs->getPos().x < rhs->getPos().x;
+  return lhs->getPos().y < rhs->getPos().y;
+}
+
 std::vector<Stack*> Stacklist::getDefendersInCity(const City *city)
 {
     debug("getDefendersInCity()");
 
     std::vector<Stack*> stackvector;
-    Vector<int> pos = city->getPos();
+    Player *owner = city->getOwner();
+    const std::list<StackTileRecord> &recs = city->getStacksOnTiles();
 
-    for (unsigned int i = pos.x; i < pos.x + city->getSize(); i++)
+    for (std::list<StackTileRecord>::const_iterator it = recs.begin();
+         it != recs.end(); ++it)
     {
-        for (unsigned int j = pos.y; j < pos.y + city->getSize(); j++)
-        {
-	    Vector<int> p = Vector<int>(i,j);
-	    std::vector<Stack *>stacks =
-	      GameMap::getFriendlyStacks(p, city->getOwner());
-	    for (std::vector<Stack*>::iterator it = stacks.begin();
-		 it != stacks.end(); ++it)
-		stackvector.push_back(*it);
-        }
+        if ((*it).player_id != owner->getId())
+          continue;
+        Stack *stack = owner->getStacklist()->getStackById((*it).stack_id);
+        if (stack)
+          stackvector.push_back(stack);
     }
 
+    //keep the stacks in the order of the city's tiles.
+    std::stable_sort(stackvector.begin(), stackvector.end(), comparePos);
     return stackvector;
 }
 
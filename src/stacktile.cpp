@@ -23,6 +23,8 @@
 #include "stacklist.h"
 #include "playerlist.h"
 #include "Tile.h"
+#include "GameMap.h"
+#include "city.h"
 
 StackTile::StackTile(Vector<int> pos)
   :tile(pos)
@@ -60,6 +62,9 @@ bool StackTile::remove(Stack* stack)
   if (it == end())
     return false;
   erase(it);
+  City *city = GameMap::getCity(tile);
+  if (city)
+    city->stackLeaves(stack->getId());
   return true;
 }
 
@@ -77,6 +82,9 @@ bool StackTile::leaving(Stack *stack)
 	    break;
 	}
       erase(it);
+      City *city = GameMap::getCity(tile);
+      if (city)
+        city->stackLeaves(stack->getId());
     }
   return true;
 }
@@ -95,9 +103,20 @@ void StackTile::add(Stack *stack)
   rec.stack_id = stack->getId();
   rec.player_id = stack->getOwner()->getId();
   push_back(rec);
+  City *city = GameMap::getCity(tile);
+  if (city)
+    city->stackArrives(rec);
   //i could stack->setpos here, but i prefer to let Stack::moveToDest do that because it's movement related, and this class is not movement related.
 }
 
+void StackTile::clear()
+{
+  std::list<StackTileRecord>::clear();
+  City *city = GameMap::getCity(tile);
+  if (city)
+    city->forgetStacksOnTiles();
+}
+
 guint32 StackTile::countNumberOfArmies(Player *owner) const
 {
   guint32 count = 0;
@@ -84,6 +84,9 @@ public:
     //! Remove the given stack from this stacktile.
     bool remove(Stack* stack);
 
+    //! Remove all stacks from this stacktile.
+    void clear();
+
     //! Set all stacks on this tile to be defending.
     void setDefending(Player *owner, bool defending);
 
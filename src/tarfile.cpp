@@ -153,21 +153,28 @@ void TarFile::clean_tmp_dir()
     }
 }
 
-bool TarFile::saveTar(Glib::ustring tmpfile, Glib::ustring tmptar, Glib::ustring dest, std::vector<Glib::ustring> extra_files) const
+bool TarFile::saveTar(Glib::ustring tmpfile, Glib::ustring tmptar, Glib::ustring dest, std::vector<Glib::ustring> extra_files, int compression) const
+{
+  return saveTarFrom(getSourceFile(), tmpfile, tmptar, dest, extra_files,
+                     compression);
+}
+
+bool TarFile::saveTarFrom(Glib::ustring infile, Glib::ustring tmpfile, Glib::ustring tmptar, Glib::ustring dest, std::vector<Glib::ustring> extra_files, int compression)
 {
   bool broken = false;
   Tar_Helper t(tmptar, std::ios::out, broken);
   if (broken == true)
     return false;
-  t.saveFile(tmpfile, File::get_basename(dest, true));
+  if (t.saveFile(tmpfile, File::get_basename(dest, true)) == false)
+    broken = true;
   //now the images, go get 'em from the tarball we were made from.
-  Glib::ustring infile = d_tmp_filename;
-  if (infile == "")
-    infile = getConfigurationFile ();
-  if (infile != "")
+  if (infile != "" && broken == false)
     {
       std::list<Glib::ustring> delfiles;
-      Tar_Helper orig(infile, std::ios::in, broken);
+      // the images go into a directory of our own, because this can run on
+      // the autosave worker's thread while the game reads the same file.
+      Tar_Helper orig(infile, std::ios::in, broken, 0,
+                      File::getTarTempDir(File::get_basename(tmptar, true)));
       if (broken == false)
         {
           std::list<Glib::ustring> extensions;
@@ -183,8 +190,8 @@ bool TarFile::saveTar(Glib::ustring tmpfile, Glib::ustring tmptar, Glib::ustring
                   Glib::ustring file = orig.getFile(*it, broken);
                   if (broken == false)
                     {
-                      t.saveFile(file);
                       delfiles.push_back(file);
+                      broken = !t.saveFile(file);
                     }
                   else
                     break;
@@ -206,26 +213,41 @@ bool TarFile::saveTar(Glib::ustring tmpfile, Glib::ustring tmptar, Glib::ustring
             broken = false;
         }
     }
-  if (extra_files.empty () == false)
+  if (extra_files.empty () == false && broken == false)
     {
       for (auto f : extra_files)
-        t.saveFile(f);
+        if (t.saveFile(f) == false)
+          {
+            broken = true;
+            break;
+          }
     }
-  t.Close();
+  if (t.Close() == false)
+    broken = true;
   File::erase(tmpfile);
   if (broken == false)
     {
-      if (File::copy(tmptar, dest) == true)
-        File::erase(tmptar);
-      else
+      bool copied;
+      if (compression)
         {
+          // compress into another temporary file, so that a failure part of
+          // the way through doesn't leave half a file where dest was.
+          Glib::ustring tmpzip = tmptar + ".z";
+          copied = Tar_Helper::copy(tmptar, tmpzip, compression);
+          if (copied)
+            copied = File::copy(tmpzip, dest);
           int save_errno = errno;
-          //all that work for nothing
-          File::erase(tmptar);
+          File::erase(tmpzip);
           errno = save_errno;
-          broken = true;
         }
+      else
+        copied = File::copy(tmptar, dest);
+      if (copied == true)
+        File::erase(tmptar);
+      else
+        broken = true;
     }
+  // when it didn't work, tmptar is left behind to see what went wrong.
   return broken == false;
 }
     
@@ -51,7 +51,21 @@ public:
 
     void clean_tmp_dir();
 
-    bool saveTar(Glib::ustring tmpfile, Glib::ustring tmptar, Glib::ustring dest, std::vector<Glib::ustring> extrafiles) const;
+    //! Put the xml file and the others into a tar file at dest.
+    /**
+     * A compression level from 1 to 9 compresses the tar file on its way
+     * to dest.
+     */
+    bool saveTar(Glib::ustring tmpfile, Glib::ustring tmptar, Glib::ustring dest, std::vector<Glib::ustring> extrafiles, int compression = 0) const;
+
+    //! Like saveTar, but the images come from the tar file named infile.
+    /**
+     * This doesn't touch any TarFile object, so it can be used on another
+     * thread.
+     */
+    static bool saveTarFrom(Glib::ustring infile, Glib::ustring tmpfile, Glib::ustring tmptar, Glib::ustring dest, std::vector<Glib::ustring> extrafiles, int compression = 0);
+    //! The tar file that saveTar gets the images from.
+    Glib::ustring getSourceFile() const {return d_tmp_filename != "" ? d_tmp_filename : getConfigurationFile ();}
     Glib::ustring getBaseName () const {return d_basename;}
     Glib::ustring getExtension () const {return d_extension;}
 
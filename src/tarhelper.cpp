@@ -26,6 +26,7 @@
 #include "File.h"
 #include <errno.h>
 #include "ucompose.hpp"
+#include "Configuration.h"
 #include <archive_entry.h>
 
 /*
@@ -38,12 +39,18 @@
  * this has the unfortunate side effect when we add N files to a tar file 
  * using saveFile.  the file gets saved out N seperate times.
  *
+ * when reading, the names of the members are kept in an index after going
+ * through the archive once.  the contents of a member are only read when
+ * it is asked for.  the archive is left open where the member ended, so
+ * getting N files in order takes one more pass instead of N of them.
+ *
  * this class was originally implemented with libtar.
  */
-Tar_Helper::Tar_Helper(Glib::ustring file, std::ios::openmode mode, bool &broken)
+Tar_Helper::Tar_Helper(Glib::ustring file, std::ios::openmode mode, bool &broken, int compression, Glib::ustring tmpdir)
+ : own_tmpoutdir(tmpdir), indexed(false), next_entry(0)
 {
   t = NULL;
-  broken = Open(file, mode);
+  broken = Open(file, mode, compression);
 }
 
 void Tar_Helper::reopen(Tar_Helper *t)
@@ -52,9 +59,37 @@ void Tar_Helper::reopen(Tar_Helper *t)
   t->Open(t->pathname, t->openmode);
 }
 
-bool Tar_Helper::Open(Glib::ustring file, std::ios::openmode mode)
+struct archive *Tar_Helper::write_new(int compression)
+{
+  struct archive *a = archive_write_new();
+  if (compression <= 0)
+    {
+      archive_write_add_filter_none(a);
+      return a;
+    }
+  // zstd is quicker for the same size, but libarchive might not have it.
+  // ARCHIVE_WARN means it would run a zstd program that might not be
+  // installed, so then we start over with gzip.
+  int r = ARCHIVE_FATAL;
+#if ARCHIVE_VERSION_NUMBER >= 3003003
+  r = archive_write_add_filter_zstd(a);
+#endif
+  if (r != ARCHIVE_OK)
+    {
+      archive_write_free(a);
+      a = archive_write_new();
+      archive_write_add_filter_gzip(a);
+    }
+  Glib::ustring level = String::ucompose("%1", CLAMP(compression, 1, 9));
+  archive_write_set_filter_option(a, NULL, "compression-level", level.c_str());
+  return a;
+}
+
+bool Tar_Helper::Open(Glib::ustring file, std::ios::openmode mode, int compression)
 {
   t = NULL;
+  if (file != pathname)
+    forget_index();
   if (mode == std::ios::in && is_tarfile (file) == false)
     return true;
   //int m;
@@ -65,6 +100,7 @@ bool Tar_Helper::Open(Glib::ustring file, std::ios::openmode mode)
       if (File::exists (file) == false)
         return false;
       t = archive_read_new ();
+      archive_read_support_filter_all(t);
       archive_read_support_format_tar(t);
       int r = archive_read_open_filename(t, file.c_str(), 8192);
       if (r != ARCHIVE_OK)
@@ -75,8 +111,7 @@ bool Tar_Helper::Open(Glib::ustring file, std::ios::openmode mode)
     }
   else if (mode & std::ios::out)
     {
-      t = archive_write_new();
-      archive_write_add_filter_none(t);
+      t = write_new(compression);
       archive_write_set_format_gnutar(t);
       if (archive_write_open_filename(t, file.c_str()))
         {
@@ -89,7 +124,10 @@ bool Tar_Helper::Open(Glib::ustring file, std::ios::openmode mode)
 
   if (mode & std::ios::in)
     {
-      tmpoutdir = File::getTarTempDir(File::get_basename(file,true));
+      if (own_tmpoutdir != "")
+        tmpoutdir = own_tmpoutdir;
+      else
+        tmpoutdir = File::getTarTempDir(File::get_basename(file,true));
       File::create_dir(tmpoutdir);
     }
   else
@@ -100,16 +138,23 @@ bool Tar_Helper::Open(Glib::ustring file, std::ios::openmode mode)
 
 int Tar_Helper::dump_entry(struct archive *in, struct archive_entry *entry, struct archive *out)
 {
-  archive_write_header(out, entry);
+  int r = archive_write_header(out, entry);
+  if (r < ARCHIVE_WARN)
+    return r;
 
   char buff[8192];
   ssize_t len = archive_read_data(in, buff, sizeof (buff));
   while (len > 0)
     {
-      archive_write_data (out, buff, len);
+      if (archive_write_data (out, buff, len) < 0)
+        return ARCHIVE_FATAL;
       len = archive_read_data(in, buff, sizeof (buff));
     }
-  archive_write_finish_entry (out);
+  if (len < 0)
+    return ARCHIVE_FATAL;
+  r = archive_write_finish_entry (out);
+  if (r < ARCHIVE_WARN)
+    return r;
   return ARCHIVE_OK;
 }
 
@@ -119,7 +164,10 @@ bool Tar_Helper::saveFile(Tar_Helper *t, Glib::ustring filename, Glib::ustring d
   //write the whole tar file to a temporary file and then copy it in place.
   Glib::ustring tmp = File::get_tmp_file();
   bool broken = false;
-  Tar_Helper out(tmp, std::ios::out, broken);
+  bool failed = false;
+  Tar_Helper out(tmp, std::ios::out, broken, get_compression(t->pathname));
+  if (broken)
+    return false;
   Tar_Helper in(t->pathname, std::ios::in, broken);
   if (!broken)
     {
@@ -129,7 +177,11 @@ bool Tar_Helper::saveFile(Tar_Helper *t, Glib::ustring filename, Glib::ustring d
           int r = archive_read_next_header(in.t, &in_entry);
           if (r == ARCHIVE_EOF || r != ARCHIVE_OK)
             break;
-          dump_entry(in.t, in_entry, out.t);
+          if (dump_entry(in.t, in_entry, out.t) != ARCHIVE_OK)
+            {
+              failed = true;
+              break;
+            }
         }
       in.Close();
     }
@@ -140,15 +192,19 @@ bool Tar_Helper::saveFile(Tar_Helper *t, Glib::ustring filename, Glib::ustring d
   else
     b = destfile;
   struct archive_entry *entry = archive_entry_new();
-  dump_file_entry (filename, entry, b, out.t);
+  if (!failed && dump_file_entry (filename, entry, b, out.t) != ARCHIVE_OK)
+    failed = true;
 
-  out.Close();
+  if (out.Close() == false)
+    failed = true;
   archive_entry_free (entry);
   archive_write_free(t->t);
   t->t = NULL;
-  File::copy(tmp, t->pathname);
+  t->forget_index();
+  if (!failed && File::copy(tmp, t->pathname) == false)
+    failed = true;
   File::erase(tmp);
-  return true;
+  return failed == false;
 }
 
 bool Tar_Helper::saveFile(Glib::ustring filename, Glib::ustring destfile)
@@ -157,13 +213,16 @@ bool Tar_Helper::saveFile(Glib::ustring filename, Glib::ustring destfile)
   return saveFile(this, filename, destfile);
 }
 
-void Tar_Helper::Close(bool clean)
+bool Tar_Helper::Close(bool clean)
 {
+  bool retval = true;
   if (t)
     {
       if (openmode & std::ios::out)
         {
-          archive_write_close (t);
+          // this is where the last of the compressed data gets written.
+          if (archive_write_close (t) < ARCHIVE_WARN)
+            retval = false;
           archive_write_free (t);
         }
       else if (openmode & std::ios::in)
@@ -175,6 +234,9 @@ void Tar_Helper::Close(bool clean)
       if (tmpoutdir != "" && clean)
         File::clean_dir(tmpoutdir);
     }
+  if (clean)
+    forget_index();
+  return retval;
 }
 
 Glib::ustring Tar_Helper::getFirstFile(std::list<Glib::ustring> exts, bool &broken)
@@ -201,59 +263,113 @@ Glib::ustring Tar_Helper::getFile(Tar_Helper *t, Glib::ustring filename, bool &b
   Glib::ustring f = File::getTempFile(tmpoutdir, filename);
   if (File::exists(f) == true)
     return f;
-  struct archive_entry *entry = NULL;
-  bool found = false;
 
-  reopen(t);
+  const std::string *data = t->getFileContents(filename);
+  if (data)
+    {
+      broken = false;
+      std::ofstream out(f.c_str(), std::ios::out | std::ios::binary);
+      out.write(data->data(), data->size());
+      out.close();
+      if (!out)
+        broken = true;
+      return f;
+    }
+
+  //broken = true;
+  // couldn't find filename in t->pathname
+  return "";
+}
+
+const std::string *Tar_Helper::getFileContents(Glib::ustring filename)
+{
+  index();
+  for (guint32 i = 0; i < entries.size(); i++)
+    if (entries[i].name == filename)
+      return load(i) ? &entries[i].data : NULL;
+  return NULL;
+}
+
+void Tar_Helper::index()
+{
+  if (indexed)
+    return;
+  entries.clear();
+  reopen(this);
+  next_entry = 0;
+  if (t == NULL)
+    return;
+  struct archive_entry *entry = NULL;
   while (1) 
     {
-      int r = archive_read_next_header(t->t, &entry);
+      int r = archive_read_next_header(t, &entry);
       if (r == ARCHIVE_EOF)
         break;
       if (r != ARCHIVE_OK)
         break;
 
-      if (filename == archive_entry_pathname(entry))
-        {
-          found = true;
-          break;
-        }
+      // the data gets skipped over when we go on to the next header.
+      Entry e;
+      e.name = archive_entry_pathname(entry);
+      e.loaded = false;
+      entries.push_back(e);
+      next_entry++;
     }
-  if (found)
-    {
-      const void *buff = NULL;
-      size_t size = 0;
-      int64_t offset = 0;
-      broken = false;
-      struct archive *ext = archive_write_disk_new();
-      archive_write_disk_set_options(ext, 
-                                     ARCHIVE_EXTRACT_OWNER |
-                                     ARCHIVE_EXTRACT_PERM);
-      Glib::ustring outfile = File::getTempFile(tmpoutdir, filename);
-      archive_entry_copy_pathname(entry, outfile.c_str());
-
-      archive_write_header(ext, entry);
+  indexed = true;
+}
 
-      while (1)
+bool Tar_Helper::load(guint32 i)
+{
+  if (entries[i].loaded)
+    return true;
+  // the members usually get asked for in order, so we only go back to the
+  // start of the archive when we've already gone past the one we want.
+  if (t == NULL || next_entry > i)
+    {
+      reopen(this);
+      next_entry = 0;
+      if (t == NULL)
+        return false;
+    }
+  struct archive_entry *entry = NULL;
+  while (next_entry <= i)
+    {
+      int r = archive_read_next_header(t, &entry);
+      if (r != ARCHIVE_OK ||
+          entries[next_entry].name != Glib::ustring(archive_entry_pathname(entry)))
         {
-          int r = archive_read_data_block(t->t, &buff, &size, &offset);
-          if (r == ARCHIVE_EOF)
-            break;
-          if (r != ARCHIVE_OK)
-            break;
-          r = archive_write_data_block(ext, buff, size, offset);
-          if (r != ARCHIVE_OK)
-            break;
+          // the archive isn't what it was when we indexed it.
+          next_entry = entries.size();
+          return false;
         }
-      archive_write_finish_entry(ext);
-      archive_write_close(ext);
-      archive_write_free(ext);
-      return outfile;
+      next_entry++;
+    }
+  Entry &e = entries[i];
+  e.data.clear();
+  if (archive_entry_size_is_set(entry))
+    e.data.reserve(archive_entry_size(entry));
+  char buff[8192];
+  ssize_t len = archive_read_data(t, buff, sizeof (buff));
+  while (len > 0)
+    {
+      e.data.append(buff, len);
+      len = archive_read_data(t, buff, sizeof (buff));
+    }
+  if (len < 0)
+    {
+      e.data.clear();
+      next_entry = entries.size();
+      return false;
     }
+  e.loaded = true;
+  return true;
+}
 
-  //broken = true;
-  // couldn't find filename in t->pathname
-  return "";
+void Tar_Helper::forget_index()
+{
+  entries.clear();
+  indexed = false;
+  next_entry = 0;
 }
 
 Glib::ustring Tar_Helper::getFile(Glib::ustring filename, bool &broken)
@@ -263,20 +379,10 @@ Glib::ustring Tar_Helper::getFile(Glib::ustring filename, bool &broken)
 
 std::list<Glib::ustring> Tar_Helper::getFilenames(Tar_Helper *t)
 {
-  reopen(t);
+  t->index();
   std::list<Glib::ustring> result;
-  //archive_seek_data(t, 0, SEEK_SET);
-  struct archive_entry *entry = NULL;
-  while (1) 
-    {
-      int r = archive_read_next_header(t->t, &entry);
-      if (r == ARCHIVE_EOF)
-        break;
-      if (r != ARCHIVE_OK)
-        break;
-
-      result.push_back(archive_entry_pathname(entry));
-    }
+  for (guint32 i = 0; i < t->entries.size(); i++)
+    result.push_back(t->entries[i].name);
   return result;
 }
 
@@ -318,6 +424,7 @@ bool Tar_Helper::is_tarfile (Glib::ustring file)
 {
   bool retval = false;
   struct archive *a = archive_read_new ();
+  archive_read_support_filter_all(a);
   archive_read_support_format_tar(a);
   int r = archive_read_open_filename (a, file.c_str(), 10240);
   struct archive_entry *entry = NULL;
@@ -331,13 +438,66 @@ bool Tar_Helper::is_tarfile (Glib::ustring file)
   return retval;
 }
 
+int Tar_Helper::get_compression (Glib::ustring file)
+{
+  // libarchive can tell that the file is compressed, but not how hard.
+  int compression = 0;
+  struct archive *a = archive_read_new ();
+  archive_read_support_filter_all(a);
+  archive_read_support_format_tar(a);
+  int r = archive_read_open_filename (a, file.c_str(), 10240);
+  struct archive_entry *entry = NULL;
+  if (r == ARCHIVE_OK)
+    {
+      archive_read_next_header(a, &entry);
+      if (archive_filter_code (a, 0) != ARCHIVE_FILTER_NONE)
+        compression = CLAMP(int(Configuration::s_zip_level), 1, 9);
+      archive_read_close(a);
+    }
+  archive_read_free(a);
+  return compression;
+}
+
+bool Tar_Helper::copy (Glib::ustring src, Glib::ustring dest, int compression)
+{
+  bool broken = false;
+  Tar_Helper in(src, std::ios::in, broken);
+  if (broken || in.t == NULL)
+    return false;
+  Tar_Helper out(dest, std::ios::out, broken, compression);
+  if (broken || out.t == NULL)
+    {
+      in.Close();
+      return false;
+    }
+  struct archive_entry *in_entry = NULL;
+  while (1)
+    {
+      int r = archive_read_next_header(in.t, &in_entry);
+      if (r == ARCHIVE_EOF)
+        break;
+      if (r != ARCHIVE_OK ||
+          dump_entry(in.t, in_entry, out.t) != ARCHIVE_OK)
+        {
+          broken = true;
+          break;
+        }
+    }
+  in.Close();
+  if (out.Close() == false)
+    broken = true;
+  return broken == false;
+}
+
 int Tar_Helper::dump_file_entry (Glib::ustring filename, struct archive_entry *entry, Glib::ustring nameinarchive, struct archive *out)
 {
     struct stat st;
     stat(filename.c_str(), &st);
     archive_entry_copy_stat(entry, &st);
     archive_entry_set_pathname(entry, nameinarchive.c_str());
-    archive_write_header(out, entry);
+    int r = archive_write_header(out, entry);
+    if (r < ARCHIVE_WARN)
+      return r;
     int fd = open (filename.c_str(), O_RDONLY);
     if (fd < 0)
       return ARCHIVE_FATAL;
@@ -346,11 +506,19 @@ int Tar_Helper::dump_file_entry (Glib::ustring filename, struct archive_entry *e
     ssize_t len = read (fd, buff, sizeof (buff));
     while (len > 0)
       {
-        archive_write_data (out, buff, len);
+        if (archive_write_data (out, buff, len) < 0)
+          {
+            close(fd);
+            return ARCHIVE_FATAL;
+          }
         len = read (fd, buff, sizeof (buff));
       }
-    archive_write_finish_entry(out);
     close(fd);
+    if (len < 0)
+      return ARCHIVE_FATAL;
+    r = archive_write_finish_entry(out);
+    if (r < ARCHIVE_WARN)
+      return r;
     return ARCHIVE_OK;
 }
 
@@ -405,7 +573,8 @@ bool Tar_Helper::replaceFile(Glib::ustring filename, Glib::ustring newfilename,
   //write the whole tar file to a temporary file and then copy it in place.
   Glib::ustring tmp = File::get_tmp_file();
   bool broken = false;
-  Tar_Helper out(tmp, std::ios::out, broken);
+  bool failed = false;
+  Tar_Helper out(tmp, std::ios::out, broken, get_compression(pathname));
   Tar_Helper in(pathname, std::ios::in, broken);
   if (!broken)
     {
@@ -421,27 +590,39 @@ bool Tar_Helper::replaceFile(Glib::ustring filename, Glib::ustring newfilename,
               newfilename != "")
             {
               //hey it's the one we want to replace
-              dump_file_entry (newfilename, in_entry, 
-                               archive_name, out.t);
+              r = dump_file_entry (newfilename, in_entry, archive_name, out.t);
             }
           else if (filename == Glib::ustring(archive_entry_pathname(in_entry)) &&
               newfilename == "")
             ; //hey it's the one we're removing
           else
-            dump_entry(in.t, in_entry, out.t);
+            r = dump_entry(in.t, in_entry, out.t);
+          if (r != ARCHIVE_OK)
+            {
+              failed = true;
+              break;
+            }
         }
       in.Close();
     }
 
-  out.Close();
-  if (filename == "")
+  if (out.Close() == false)
+    failed = true;
+  if (filename == "" && !failed)
     {
       Tar_Helper i(tmp, std::ios::in, broken);
-      saveFile (&i, newfilename, archive_name);
+      if (saveFile (&i, newfilename, archive_name) == false)
+        failed = true;
       i.Close();
     }
   archive_write_free(t);
   t = NULL;
+  forget_index();
+  if (failed)
+    {
+      File::erase(tmp);
+      return false;
+    }
   bool ret = File::copy(tmp, pathname);
   int save_errno = errno;
   if (ret)
@@ -23,6 +23,8 @@
 #include <glibmm.h>
 #include <iosfwd>
 #include <list>
+#include <vector>
+#include <string>
 #include <cstdio>
 
 //! An interface for operating on tar archive files.
@@ -31,7 +33,18 @@ class Tar_Helper
 public:
 
     //! Constructor
-    Tar_Helper(Glib::ustring file, std::ios::openmode mode, bool &broken);
+    /**
+     * When writing, a compression level from 1 to 9 makes a compressed tar
+     * file, and 0 makes a plain one.  Compressed tar files are read just
+     * like plain ones.
+     *
+     * When reading, the files that are asked for go into a temporary
+     * directory that is shared with the other Tar_Helpers reading the same
+     * file.  Give a tmpdir to use a directory of our own instead, like when
+     * reading on another thread.
+     */
+    Tar_Helper(Glib::ustring file, std::ios::openmode mode, bool &broken,
+               int compression = 0, Glib::ustring tmpdir = "");
 
     //! Destructor
     ~Tar_Helper();
@@ -40,6 +53,13 @@ public:
 
     Glib::ustring getFile(Glib::ustring filename, bool &broken);
 
+    //! Returns the bytes of the member named filename, or NULL if it isn't there.
+    /**
+     * Only this member is read into memory, and it is served from there
+     * the next time it is asked for.
+     */
+    const std::string *getFileContents(Glib::ustring filename);
+
     //Glib::ustring getFirstFile(bool &broken);
     Glib::ustring getFirstFile(Glib::ustring extension, bool &broken);
     Glib::ustring getFirstFile(std::list<Glib::ustring> exts, bool &broken);
@@ -54,6 +74,8 @@ public:
 
     //! Replaces old_filename with new_filename, or adds it if not present.
     /**
+     * A compressed tar file stays compressed.
+     *
      * archive name is the name of the member in the archive.
      * new_filename is the place on disk of the file we want to add or replace.
      * old_filename is the name of the member in the archive that we want to
@@ -73,11 +95,32 @@ public:
     bool replaceFile(Glib::ustring old_filename, Glib::ustring new_filename,
                      Glib::ustring archive_name);
 
-    bool Open(Glib::ustring file, std::ios::openmode mode);
-    void Close(bool clean = true);
+    bool Open(Glib::ustring file, std::ios::openmode mode,
+              int compression = 0);
+    //! Close the archive.
+    /**
+     * @return false if the end of an archive being written couldn't be
+     *         written out.
+     */
+    bool Close(bool clean = true);
 
     static bool is_tarfile (Glib::ustring file);
 
+    //! Copy every member of one tar file to a new one in a single pass.
+    /**
+     * This is how a tar file gets compressed, after its members have been
+     * added to it one at a time.
+     */
+    static bool copy (Glib::ustring src, Glib::ustring dest,
+                      int compression = 0);
+
+    //! Returns how hard to compress a tar file that replaces the given one.
+    /**
+     * A compressed tar file is compressed again at the configured level
+     * when it gets rewritten, and a plain one stays plain.
+     */
+    static int get_compression (Glib::ustring file);
+
     static Glib::ustring getFile(Tar_Helper *t, Glib::ustring filename, bool &broken, Glib::ustring tmpoutdir);
     static std::list<Glib::ustring> getFilenames(Tar_Helper *t);
     static bool saveFile(Tar_Helper *t, Glib::ustring filename, Glib::ustring destfile = "");
@@ -86,11 +129,37 @@ public:
     static int dump_entry(struct archive *in, struct archive_entry *entry, struct archive *out);
     static int dump_file_entry(Glib::ustring filename, struct archive_entry *entry, Glib::ustring nameinarchive, struct archive *out);
 private:
+    //! Make an archive for writing, with the given level of compression.
+    static struct archive *write_new(int compression);
+
+    //! Go through the archive once, keeping the names of the members.
+    void index();
+
+    //! Read the contents of the i'th member of the index into memory.
+    bool load(guint32 i);
+
+    //! Forget the index because the archive has changed.
+    void forget_index();
+
+    //! A member of the archive.
+    struct Entry
+    {
+      Glib::ustring name;
+      std::string data;
+      bool loaded;
+    };
 
     // DATA
     struct archive *t;
     std::ios::openmode openmode;
     Glib::ustring tmpoutdir;
+    Glib::ustring own_tmpoutdir;
     Glib::ustring pathname;
+
+    //! The members of the archive, in order, once it has been indexed.
+    std::vector<Entry> entries;
+    bool indexed;
+    //! Which member of the index has its header read next.
+    guint32 next_entry;
 };
 #endif
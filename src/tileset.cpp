@@ -509,6 +509,7 @@ void Tileset::uninstantiateImages()
 
   for (auto i : getMaskedImages ())
     i->uninstantiateImages ();
+  setInstantiated (false);
 }
 
 void Tileset::instantiateImages(bool scale, bool &broken)
@@ -601,6 +602,7 @@ void Tileset::instantiateImages(bool scale, bool &broken)
   d_fog->instantiateImages ();
 
   t.Close();
+  setInstantiated (true);
   return;
 }
 
@@ -72,19 +72,6 @@ void Tilesetlist::uninstantiateImages()
     (*it)->uninstantiateImages();
 }
 
-void Tilesetlist::instantiateImages(bool &broken)
-{
-  broken = false;
-  for (iterator it = begin(); it != end(); ++it)
-    {
-      if (!broken)
-        {
-          if ((*it)->validate () == true)
-            (*it)->instantiateImages(true, broken);
-        }
-    }
-}
-
 SmallTile *Tilesetlist::getSmallTile(Glib::ustring basename, Tile::Type type) const
 {
   Tileset *ts = get(basename);
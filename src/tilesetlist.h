@@ -53,9 +53,6 @@ class Tilesetlist : public SetList<Tileset>, public sigc::trackable
 
 	//! Destroy all of the tileset images in this list.
 	void uninstantiateImages();
-        
-	//! Load the images for all tilesets in this list.
-	void instantiateImages(bool &broken);
 
 
 	// Static Methods
@@ -125,14 +125,24 @@ void TileStyleSet::loadImages(int tilesize, Glib::ustring filename,
     {
       std::vector<PixMask *> styles = disassemble_row(filename, size(), broken);
       if (!broken)
-        {
-          for (unsigned int i = 0; i < size(); i++)
-            {
-              if (scale)
-                PixMask::scale(styles[i], tilesize, tilesize);
-              (*this)[i]->setImage(styles[i]);
-            }
-        }
+        setImages(styles, tilesize, scale);
+    }
+}
+
+void TileStyleSet::loadImages(int tilesize, Glib::RefPtr<Gdk::Pixbuf> row,
+                              bool scale)
+{
+  setImages(disassemble_row(row, size()), tilesize, scale);
+}
+
+void TileStyleSet::setImages(std::vector<PixMask *> styles, int tilesize,
+                             bool scale)
+{
+  for (unsigned int i = 0; i < size(); i++)
+    {
+      if (scale)
+        PixMask::scale(styles[i], tilesize, tilesize);
+      (*this)[i]->setImage(styles[i]);
     }
 }
 
@@ -146,16 +156,13 @@ bool TileStyleSet::instantiateImages (Tileset *set)
   Glib::ustring imgname = getName();
   if (imgname.empty() == false)
     {
-      Glib::ustring filename = t.getFile(imgname, broken);
-      if (!broken)
+      const std::string *data = t.getFileContents(imgname);
+      if (data)
         {
-          std::vector<PixMask *> styles =
-            disassemble_row(filename, size(), broken);
+          Glib::RefPtr<Gdk::Pixbuf> row =
+            PixMask::load_pixbuf(*data, imgname, broken);
           if (!broken)
-            {
-              for (unsigned int i = 0; i < size(); i++)
-                (*this)[i]->setImage(styles[i]);
-            }
+            loadImages(0, row, false);
         }
     }
   return broken;
@@ -109,6 +109,10 @@ class TileStyleSet : public sigc::trackable, public std::vector<TileStyle*>
 	void loadImages(int tilesize, Glib::ustring image_filename,
                         bool scale, bool &broken);
 
+	//! Instantiate the tilestyleset's images from an image already loaded.
+	void loadImages(int tilesize, Glib::RefPtr<Gdk::Pixbuf> row,
+                        bool scale);
+
 	//! Destroy the images associated with this tilestyleset.
 	void uninstantiateImages();
 
@@ -117,6 +121,9 @@ class TileStyleSet : public sigc::trackable, public std::vector<TileStyle*>
         bool instantiateImages (Tileset *set);
 
     private:
+	//! Hand out the images cut from the row to the tilestyles.
+	void setImages(std::vector<PixMask *> styles, int tilesize, bool scale);
+
 
 	// DATA
 
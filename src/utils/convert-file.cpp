@@ -0,0 +1,129 @@
+// Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#include <config.h>
+
+#include <iostream>
+#include <stdlib.h>
+#include <glibmm.h>
+#include "Configuration.h"
+#include "File.h"
+#include "vector.h"
+#include "ucompose.hpp"
+#include "xmlhelper.h"
+#include "tarhelper.h"
+
+int max_vector_width;
+
+void show_help(Glib::ustring progname)
+{
+  std::cout << String::ucompose(_("Usage: %1 [OPTION]... FILE"), progname) << std::endl << std::endl;
+  std::cout << "LordsAWar! File Converting Tool " << _("version") <<
+    " " << VERSION << std::endl << std::endl;
+  std::cout << _("Options:") << std::endl << std::endl;
+  std::cout << "  -?, --help                 " << _("Display this help and exit") <<std::endl;
+  std::cout << "  -b, --binary               " << _("Convert the file to the compact binary form") <<std::endl;
+  std::cout << "  -x, --xml                  " << _("Convert the file to xml (the default)") <<std::endl;
+  std::cout << std::endl;
+  std::cout << _("Report bugs to") << " <" << PACKAGE_BUGREPORT ">." << std::endl;
+}
+
+bool convert_tar_file(Glib::ustring filename, bool binary)
+{
+  bool broken = false;
+  Tar_Helper t(filename, std::ios::in, broken);
+  if (broken)
+    return false;
+  // the main file in the tar file has the same extension as the tar file.
+  Glib::ustring ext = File::get_extension(filename);
+  Glib::ustring tmpfile = t.getFirstFile(ext, broken);
+  bool converted = false;
+  if (!broken && tmpfile != "")
+    {
+      converted = XML_Helper::convertFile(tmpfile, binary);
+      if (converted)
+        {
+          Glib::ustring n = t.getFirstFilename(ext);
+          converted = t.replaceFile(n, tmpfile, n);
+        }
+    }
+  t.Close();
+  if (tmpfile != "")
+    File::erase(tmpfile);
+  return converted;
+}
+
+int
+main (int argc, char* argv[])
+{
+  Glib::ustring filename;
+  bool binary = false;
+  initialize_configuration();
+  Vector<int>::setMaximumWidth(1000);
+
+  Glib::init();
+  #if ENABLE_NLS
+  setlocale(LC_ALL, Configuration::s_lang.c_str());
+  bindtextdomain (GETTEXT_PACKAGE, LOCALEDIR);
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+  textdomain (GETTEXT_PACKAGE);
+  #endif
+
+  if (argc == 1)
+    {
+      show_help(argv[0]);
+      exit (0);
+    }
+
+  for (int i = 2; i <= argc; i++)
+    {
+      Glib::ustring parameter(argv[i-1]);
+      if (parameter == "--help" || parameter == "-?")
+        {
+          show_help(argv[0]);
+          exit(0);
+        }
+      else if (parameter == "--binary" || parameter == "-b")
+        binary = true;
+      else if (parameter == "--xml" || parameter == "-x")
+        binary = false;
+      else
+        filename = parameter;
+    }
+
+  if (filename == "")
+    {
+      show_help(argv[0]);
+      exit (EXIT_FAILURE);
+    }
+
+  if (File::exists (filename) == false)
+    {
+      std::cerr << String::ucompose(_("Error: Couldn't open `%1' for reading."), filename) << std::endl;
+      exit (EXIT_FAILURE);
+    }
+
+  bool converted;
+  if (Tar_Helper::is_tarfile(filename))
+    converted = convert_tar_file(filename, binary);
+  else
+    converted = XML_Helper::convertFile(filename, binary);
+  if (!converted)
+    std::cerr << String::ucompose(_("Error: Couldn't convert `%1'."), filename) << std::endl;
+
+  return converted ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+// Copyright (C) 2026 Ben Asselstine
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Library General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//  02110-1301, USA.
+
+#include <config.h>
+
+#include <iostream>
+#include <stdlib.h>
+#include <gtkmm.h>
+#include "Configuration.h"
+#include "File.h"
+#include "vector.h"
+#include "ucompose.hpp"
+#include "GameScenario.h"
+#include "GameMap.h"
+#include "playerlist.h"
+#include "bigmap.h"
+
+int max_vector_width;
+
+void show_help(Glib::ustring progname)
+{
+  std::cout << String::ucompose(_("Usage: %1 [OPTION]... FILE PNGFILE"), progname) << std::endl << std::endl;
+  std::cout << "LordsAWar! Map Exporting Tool " << _("version") <<
+    " " << VERSION << std::endl << std::endl;
+  std::cout << _("Options:") << std::endl << std::endl;
+  std::cout << "  -?, --help                 " << _("Display this help and exit") <<std::endl;
+  std::cout << "  -s, --scale NUM            " << _("Make the image this many times the size of the map") <<std::endl;
+  std::cout << "  -w, --width NUM            " << _("Make the image this many pixels wide") <<std::endl;
+  std::cout << std::endl;
+  std::cout << _("Report bugs to") << " <" << PACKAGE_BUGREPORT ">." << std::endl;
+}
+
+int
+main (int argc, char* argv[])
+{
+  Glib::ustring filename;
+  Glib::ustring pngfile;
+  double scale = 1.0;
+  int width = 0;
+  initialize_configuration();
+  Vector<int>::setMaximumWidth(1000);
+
+  // we draw images, but we never open a window, so we don't need a display.
+  Glib::init();
+  Gtk::Main::init_gtkmm_internals();
+  #if ENABLE_NLS
+  setlocale(LC_ALL, Configuration::s_lang.c_str());
+  bindtextdomain (GETTEXT_PACKAGE, LOCALEDIR);
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+  textdomain (GETTEXT_PACKAGE);
+  #endif
+
+  if (argc == 1)
+    {
+      show_help(argv[0]);
+      exit (0);
+    }
+
+  for (int i = 2; i <= argc; i++)
+    {
+      Glib::ustring parameter(argv[i-1]);
+      if (parameter == "--help" || parameter == "-?")
+        {
+          show_help(argv[0]);
+          exit(0);
+        }
+      else if ((parameter == "--scale" || parameter == "-s") && i < argc)
+        {
+          i++;
+          char *error = 0;
+          scale = strtod(argv[i-1], &error);
+          if ((error && *error != '\0') || scale <= 0)
+            {
+              std::cerr << _("invalid value for --scale") << std::endl;
+              exit (EXIT_FAILURE);
+            }
+        }
+      else if ((parameter == "--width" || parameter == "-w") && i < argc)
+        {
+          i++;
+          char *error = 0;
+          width = strtol(argv[i-1], &error, 10);
+          if ((error && *error != '\0') || width <= 0)
+            {
+              std::cerr << _("invalid value for --width") << std::endl;
+              exit (EXIT_FAILURE);
+            }
+        }
+      else if (filename == "")
+        filename = parameter;
+      else
+        pngfile = parameter;
+    }
+
+  if (filename == "" || pngfile == "")
+    {
+      show_help(argv[0]);
+      exit (EXIT_FAILURE);
+    }
+
+  if (File::exists (filename) == false)
+    {
+      std::cerr << String::ucompose(_("Error: Couldn't open `%1' for reading."), filename) << std::endl;
+      exit (EXIT_FAILURE);
+    }
+
+  bool broken = false;
+  GameScenario *game_scenario = new GameScenario(filename, broken);
+  if (broken)
+    {
+      std::cerr << String::ucompose(_("Error: Couldn't load `%1'."), filename) << std::endl;
+      exit (EXIT_FAILURE);
+    }
+
+  // show the map the way that nobody in particular would see it.  the fog
+  // is left off, because neutral isn't a human player and on a hidden map
+  // it would see nothing but fog.
+  Playerlist *pl = Playerlist::getInstance();
+  pl->setViewingplayer(pl->getNeutral());
+
+  if (width)
+    scale = double(width) /
+      (GameMap::getWidth() * GameMap::getInstance()->getTileSize());
+
+  BigMap bigmap(false);
+  bool saved = bigmap.saveAsBitmap(pngfile, scale, false);
+  if (!saved)
+    std::cerr << String::ucompose(_("Error: Couldn't write `%1'."), pngfile) << std::endl;
+
+  delete game_scenario;
+  return saved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
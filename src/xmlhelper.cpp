@@ -21,6 +21,9 @@
 #include <config.h>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <string.h>
 #include "xmlhelper.h"
 #include "defs.h"
 #include "File.h"
@@ -28,6 +31,40 @@
 
 //#define debug(x) {std::cerr<<__FILE__<<": "<<__LINE__<<": "<<x<<std::endl<<std::flush;}
 #define debug(x)
+
+//! How much of a document is held in memory before it goes out to the file.
+#define OUTPUT_BUFFER_SIZE 65536
+
+//! How much of a document is handed to the parser at a time.
+#define PARSE_CHUNK_SIZE 1048576
+
+//! The first bytes of a document in the binary form.
+#define BINARY_MAGIC "LWBX"
+#define BINARY_MAGIC_SIZE 4
+
+//! Which revision of the binary form gets written.
+#define BINARY_FORMAT_VERSION 1
+
+//! The kinds of records in the binary form.
+enum BinaryRecord
+{
+  //! A tag name, and the version if it is the first tag.
+  BINARY_OPEN_TAG = 1,
+  BINARY_CLOSE_TAG,
+  //! A data tag name, and a string.
+  BINARY_STRING,
+  //! A data tag name, and a signed number.
+  BINARY_INT,
+  //! A data tag name, and an unsigned number.
+  BINARY_UINT,
+  //! A data tag name holding "true".
+  BINARY_TRUE,
+  //! A data tag name holding "false".
+  BINARY_FALSE,
+  //! The language of the next data tag.
+  BINARY_LANG,
+};
+
 Glib::ustring XML_Helper::xml_entity = "<?xml version=\"1.0\" encoding=\"utf-8\"?>";
 
 // forward declarations of the internally used functions
@@ -36,9 +73,10 @@ Glib::ustring XML_Helper::xml_entity = "<?xml version=\"1.0\" encoding=\"utf-8\"
 //void end_handler(void* udata, const XML_Char* name);
 
 XML_Helper::XML_Helper(Glib::ustring filename, std::ios::openmode mode)
-  : xmlpp::SaxParser(), d_inbuf(0), d_outbuf(0), d_fout(0), d_fin(0), 
-    d_out(0), d_in(0), d_last_opened(""), d_version(""), d_failed(false), 
-    my_cdata(""), error(false)
+  : xmlpp::SaxParser(), d_inbuf(0), d_fout(0), d_fin(0), 
+    d_out(0), d_in(0), d_num_data(0), d_last_opened(0), d_version(""),
+    d_binary(false), d_copy_to(0), d_failed(false), my_cdata(""),
+    error(false)
 {
     debug("Constructor called  -- ")
         
@@ -53,7 +91,8 @@ XML_Helper::XML_Helper(Glib::ustring filename, std::ios::openmode mode)
     //open input stream if required
     if (mode & std::ios::in)
     {
-        d_fin = new std::ifstream(filename.c_str(), std::ios::in);
+        d_fin = new std::ifstream(filename.c_str(),
+                                  std::ios::in | std::ios::binary);
 
         if (!(*d_fin))
         //error opening
@@ -64,35 +103,46 @@ XML_Helper::XML_Helper(Glib::ustring filename, std::ios::openmode mode)
 
         d_fin->seekg(0, std::ios::beg);
         d_in = d_fin;
+        d_filename = filename;
     }
 
     if (mode & std::ios::out)
     {
-        d_fout = new std::ofstream(filename.c_str(),
-                                   std::ios::out & std::ios::trunc);
+        // the document is written straight to the file as it is made,
+        // going out a buffer-full at a time.  the buffer has to be
+        // handed over before the file is opened.
+        d_fout_buffer.resize(OUTPUT_BUFFER_SIZE);
+        d_fout = new std::ofstream();
+        d_fout->rdbuf()->pubsetbuf(&d_fout_buffer[0], d_fout_buffer.size());
+        std::ios::openmode fmode = std::ios::out | std::ios::trunc;
+        if (mode & std::ios::binary)
+          {
+            d_binary = true;
+            fmode |= std::ios::binary;
+          }
+        d_fout->open(filename.c_str(), fmode);
         if (!(*d_fout))
         {
             std::cerr << String::ucompose(_("Error opening `%1' for writing.  Exiting."), filename) << std::endl;
             exit(-1);
         }
 
-        d_outbuf = new std::ostringstream();
-        d_out = d_outbuf;
+        d_out = d_fout;
     }
 }
 
-XML_Helper::XML_Helper(std::ostream* output)
-  : d_inbuf(0), d_outbuf(0), d_fout(0), d_fin(0), d_out(0), d_in(0),
-    d_last_opened(""), d_version(""), d_failed(false), my_cdata(""), 
-    error(false)
+XML_Helper::XML_Helper(std::ostream* output, bool binary)
+  : d_inbuf(0), d_fout(0), d_fin(0), d_out(0), d_in(0),
+    d_num_data(0), d_last_opened(0), d_version(""), d_binary(binary),
+    d_copy_to(0), d_failed(false), my_cdata(""), error(false)
 {
   d_out = output;
 }
 
 XML_Helper::XML_Helper(std::istream* input)
-  : d_inbuf(0), d_outbuf(0), d_fout(0), d_fin(0), d_out(0), d_in(0),
-    d_last_opened(""), d_version(""), d_failed(false), my_cdata(""), 
-    error(false)
+  : d_inbuf(0), d_fout(0), d_fin(0), d_out(0), d_in(0),
+    d_num_data(0), d_last_opened(0), d_version(""), d_binary(false),
+    d_copy_to(0), d_failed(false), my_cdata(""), error(false)
 {
   d_in = input;
 }
@@ -103,8 +153,8 @@ XML_Helper::~XML_Helper()
       {
     // should never happen unless there was an error
         std::cerr << "Error parsing: ";
-        for (std::list<Glib::ustring>::reverse_iterator i = d_tags.rbegin(); i != d_tags.rend(); ++i)
-          std::cerr << (*i) << "/";
+        for (guint32 i = 0; i < d_tags.size(); i++)
+          std::cerr << *d_tags[i] << "/";
         std::cerr << "\n";
       }
     
@@ -112,10 +162,114 @@ XML_Helper::~XML_Helper()
     close();
 }
 
+//! Turns a signed number into an unsigned one that stays small when the
+//! signed number is close to zero.
+static guint64 zigzag(gint64 value)
+{
+  return (guint64(value) << 1) ^ guint64(value >> 63);
+}
+
+static gint64 unzigzag(guint64 value)
+{
+  return gint64(value >> 1) ^ -gint64(value & 1);
+}
+
+static Glib::ustring rgb_to_string(const Gdk::RGBA &value)
+{
+  char buf[8];
+  guint32 r = value.get_red() * 255;
+  guint32 g = value.get_green() * 255;
+  guint32 b = value.get_blue() * 255;
+  snprintf(buf, sizeof(buf), "#%02X%02X%02X", r, g, b);
+  return buf;
+}
+
+static bool read_varint(const unsigned char *&p, const unsigned char *end, guint64 &value)
+{
+  value = 0;
+  for (guint32 shift = 0; p < end && shift < 64; shift += 7)
+    {
+      unsigned char c = *p++;
+      value |= guint64(c & 0x7f) << shift;
+      if ((c & 0x80) == 0)
+        return true;
+    }
+  return false;
+}
+
+static bool read_string(const unsigned char *&p, const unsigned char *end, std::string &value)
+{
+  guint64 len = 0;
+  if (!read_varint(p, end, len) || len > guint64(end - p))
+    return false;
+  value.assign((const char*)p, len);
+  p += len;
+  return true;
+}
+
+static bool read_name(const unsigned char *&p, const unsigned char *end, std::vector<Glib::ustring> &names, guint32 &id)
+{
+  guint64 num = 0;
+  if (!read_varint(p, end, num) || num > names.size())
+    return false;
+  if (num == names.size())
+    {
+      // a name we haven't seen yet is spelled out
+      std::string name;
+      if (!read_string(p, end, name) || name.empty())
+        return false;
+      names.push_back(name);
+    }
+  id = num;
+  return true;
+}
+
+static bool is_binary(const char *data, gsize len)
+{
+  return len > BINARY_MAGIC_SIZE &&
+    memcmp(data, BINARY_MAGIC, BINARY_MAGIC_SIZE) == 0;
+}
+
+void XML_Helper::put_varint(guint64 value)
+{
+  while (value >= 0x80)
+    {
+      d_out->put(char((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+  d_out->put(char(value));
+}
+
+void XML_Helper::put_string(const std::string &value)
+{
+  put_varint(value.size());
+  d_out->write(value.data(), value.size());
+}
+
+void XML_Helper::put_name(const std::string &name)
+{
+  std::map<std::string, guint32>::iterator it = d_binary_names.find(name);
+  if (it != d_binary_names.end())
+    {
+      put_varint(it->second);
+      return;
+    }
+  guint32 id = d_binary_names.size();
+  d_binary_names[name] = id;
+  put_varint(id);
+  put_string(name);
+}
+
 bool XML_Helper::begin(Glib::ustring version)
 {
     d_version = version;
-    (*d_out) << xml_entity << std::endl;
+    if (d_binary)
+      {
+        d_out->write(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+        d_out->put(BINARY_FORMAT_VERSION);
+      }
+    else
+      (*d_out) << xml_entity << "\n";
 
     return true;
 }
@@ -134,6 +288,16 @@ bool XML_Helper::openTag(Glib::ustring name)
         return false;
     }
 
+    if (d_binary)
+      {
+        d_out->put(BINARY_OPEN_TAG);
+        put_name(name.raw());
+        if (d_tags.empty())
+          put_string(d_version.raw());
+        d_tags.push_back(intern(name));
+        return true;
+      }
+
     addTabs();
 
     // append the version strin got the first opened tag
@@ -142,7 +306,7 @@ bool XML_Helper::openTag(Glib::ustring name)
     else
         (*d_out) <<"<" <<name <<">\n";
         
-    d_tags.push_front(name);
+    d_tags.push_back(intern(name));
     return true;
 }
 
@@ -154,13 +318,19 @@ bool XML_Helper::closeTag()
         return false;
     }
 
-    Glib::ustring name = (*d_tags.begin());
+    const std::string *name = d_tags.back();
     
     //remove tag from list
-    d_tags.pop_front();
+    d_tags.pop_back();
+
+    if (d_binary)
+      {
+        d_out->put(BINARY_CLOSE_TAG);
+        return true;
+      }
 
     addTabs();
-    (*d_out) <<"</" <<name <<">\n";
+    (*d_out) <<"</" <<*name <<">\n";
 
     return true;
 }
@@ -181,6 +351,17 @@ bool XML_Helper::saveData(Glib::ustring name, const std::vector<Gdk::RGBA> value
         return false;
     }
 
+    if (d_binary)
+      {
+        Glib::ustring colors;
+        for (auto value : values)
+          colors += (colors.empty() ? "" : " ") + rgb_to_string(value);
+        d_out->put(BINARY_STRING);
+        put_name(name.raw());
+        put_string(colors.raw());
+        return true;
+      }
+
     addTabs();
     (*d_out) <<"<" <<name <<">";
 
@@ -227,6 +408,14 @@ bool XML_Helper::saveData(Glib::ustring name, Glib::ustring value)
         return false;
     }
 
+    if (d_binary)
+      {
+        d_out->put(BINARY_STRING);
+        put_name(name.raw());
+        put_string(value.raw());
+        return true;
+      }
+
     addTabs();
     (*d_out) <<"<" <<name <<">" <<Glib::Markup::escape_text(value) <<"</" <<name <<">\n";
     return true;
@@ -248,6 +437,14 @@ bool XML_Helper::saveData(Glib::ustring name, int value)
         return false;
     }
 
+    if (d_binary)
+      {
+        d_out->put(BINARY_INT);
+        put_name(name.raw());
+        put_varint(zigzag(value));
+        return true;
+      }
+
     addTabs();
     (*d_out) <<"<" <<name <<">" <<value <<"</" <<name <<">\n";
     return true;
@@ -269,6 +466,14 @@ bool XML_Helper::saveData(Glib::ustring name, guint32 value)
         return false;
     }
 
+    if (d_binary)
+      {
+        d_out->put(BINARY_UINT);
+        put_name(name.raw());
+        put_varint(value);
+        return true;
+      }
+
     addTabs();
     (*d_out) <<"<" <<name <<">" <<value <<"</" <<name <<">\n";
     return true;
@@ -293,6 +498,13 @@ bool XML_Helper::saveData(Glib::ustring name, bool value)
     Glib::ustring s;
     s = (value? "true" : "false");
 
+    if (d_binary)
+      {
+        d_out->put(value ? BINARY_TRUE : BINARY_FALSE);
+        put_name(name.raw());
+        return true;
+      }
+
     addTabs();
     (*d_out) <<"<" <<name <<">" <<s <<"</" <<name <<">\n";
     return true;
@@ -314,6 +526,17 @@ bool XML_Helper::saveData(Glib::ustring name, double value)
         return false;
     }
 
+    if (d_binary)
+      {
+        // kept as the same text that the xml form has
+        std::ostringstream os;
+        os << value;
+        d_out->put(BINARY_STRING);
+        put_name(name.raw());
+        put_string(os.str());
+        return true;
+      }
+
     addTabs();
     (*d_out) <<"<" <<name <<">" <<value <<"</" <<name <<">\n";
     return true;
@@ -326,17 +549,7 @@ bool XML_Helper::saveData(Glib::ustring name, unsigned long int value)
 
 bool XML_Helper::close()
 {
-    if (d_outbuf)        
-      {
-        std::string tmp = d_outbuf->str();
-        d_fout->write(tmp.c_str(), tmp.length());
-        d_fout->flush();
-
-        delete d_outbuf;
-        d_outbuf = 0;
-        debug("destroyed d_outbuf")
-      }
-
+    bool retval = true;
     if (d_inbuf)        
     {
         delete d_inbuf;
@@ -347,6 +560,8 @@ bool XML_Helper::close()
     if (d_fout)
     {
         d_fout->close();
+        if (d_fout->fail())
+          retval = false;
         delete d_fout;
         d_fout = 0;
     }
@@ -361,7 +576,7 @@ bool XML_Helper::close()
     d_out = 0;
     d_in = 0;
         
-    return true;
+    return retval;
 }
 
 void XML_Helper::addTabs()
@@ -370,34 +585,103 @@ void XML_Helper::addTabs()
         (*d_out)<<"\t";
 }
 
+bool XML_Helper::copyData(const Glib::ustring &name, const Glib::ustring &value, const Glib::ustring &lang)
+{
+    if (!d_binary)
+      {
+        if (lang.empty())
+          return saveData(name, value);
+        addTabs();
+        (*d_out) <<"<d_" <<name <<" xml:lang=\"" <<Glib::Markup::escape_text(lang) <<"\">" <<Glib::Markup::escape_text(value) <<"</d_" <<name <<">\n";
+        return true;
+      }
+
+    if (lang.empty() == false)
+      {
+        d_out->put(BINARY_LANG);
+        put_string(lang.raw());
+      }
+
+    // numbers and booleans are kept as numbers, as long as they will be
+    // read back as exactly the same text.
+    const std::string &v = value.raw();
+    if (v == "true")
+      return saveData(name, true);
+    if (v == "false")
+      return saveData(name, false);
+    size_t digits = v.size() - (v[0] == '-' ? 1 : 0);
+    bool number = v.empty() == false && digits > 0 && digits <= 18;
+    for (size_t i = v.size() - digits; number && i < v.size(); i++)
+      number = g_ascii_isdigit(v[i]);
+    if (number && v[v.size() - digits] == '0' && v != "0")
+      number = false;
+    if (number)
+      {
+        d_out->put(BINARY_INT);
+        put_name("d_" + name.raw());
+        put_varint(zigzag(g_ascii_strtoll(v.c_str(), NULL, 10)));
+        return true;
+      }
+    return saveData(name, value);
+}
+
+bool XML_Helper::isBinaryFile(Glib::ustring filename)
+{
+  char buffer[BINARY_MAGIC_SIZE + 1];
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  in.read(buffer, sizeof buffer);
+  return is_binary(buffer, in.gcount());
+}
+
+bool XML_Helper::convertFile(Glib::ustring filename, bool binary)
+{
+  if (File::exists(filename) == false)
+    return false;
+  if (isBinaryFile(filename) == binary)
+    return true;
+
+  Glib::ustring tmpfile = File::get_tmp_file();
+  bool retval;
+    {
+      XML_Helper out(tmpfile, binary ? std::ios::out | std::ios::binary :
+                     std::ios::out);
+      XML_Helper in(filename, std::ios::in);
+      in.d_copy_to = &out;
+      retval = in.parseXML();
+      retval &= out.close();
+    }
+  if (retval == false)
+    {
+      File::erase(tmpfile);
+      return false;
+    }
+  File::erase(filename);
+  return File::rename(tmpfile, filename);
+}
+
 //loading
 bool XML_Helper::registerTag(Glib::ustring tag, XML_Slot callback)
 {
     //register tag as important
-    d_callbacks[tag] = callback;
+    d_callbacks[tag.raw()] = callback;
 
     return true;
 }
 
-bool XML_Helper::getData(std::vector<Gdk::RGBA> & data, Glib::ustring name)
+bool XML_Helper::getData(std::vector<Gdk::RGBA> & data, const Glib::ustring &name)
 {
-  //the data tags are stored with leading "d_", so prepend it here
-  name = "d_" + name;
-
-  std::map<Glib::ustring, Glib::ustring>::const_iterator it;
-
-  it = d_data.find(name);
+  const Glib::ustring *it = findData(name);
 
-  if (it == d_data.end())
+  if (it == NULL)
     {
       Gdk::RGBA d;
       d.set_rgba(0,0,0);
       data.push_back (d);
-      std::cerr<<String::ucompose(_("Error!  couldn't get Gdk::RGBA values from xml tag `%1'."), name) << std::endl;
+      std::cerr<<String::ucompose(_("Error!  couldn't get Gdk::RGBA values from xml tag `%1'."), "d_" + name) << std::endl;
       d_failed = true;
       return false;
     }
-  Glib::ustring value = (*it).second;
+  Glib::ustring value = *it;
   std::stringstream scolors;
   scolors.str (value);
   std::list<Glib::ustring> colors;
@@ -454,50 +738,41 @@ bool XML_Helper::getData(std::vector<Gdk::RGBA> & data, Glib::ustring name)
   return true;
 }
 
-bool XML_Helper::getData(Glib::ustring& data, Glib::ustring name)
+bool XML_Helper::getData(Glib::ustring& data, const Glib::ustring &name)
 {
-    //the data tags are stored with leading "d_", so prepend it here
-    name = "d_" + name;
-
-    std::map<Glib::ustring, Glib::ustring>::const_iterator it;
+    const Glib::ustring *it = findData(name);
 
-    it = d_data.find(name);
-    
-    if (it == d_data.end())
+    if (it == NULL)
     {
         data = "";
-        std::cerr<<String::ucompose(_("Error!  couldn't get Glib::ustring value from xml tag `%1'."), name) << std::endl;
+        std::cerr<<String::ucompose(_("Error!  couldn't get Glib::ustring value from xml tag `%1'."), "d_" + name) << std::endl;
         d_failed = true;
         return false;
     }
     
-    data = (*it).second;
+    data = *it;
 
     return true;
 }
 
-bool XML_Helper::getData(bool& data, Glib::ustring name)
+bool XML_Helper::getData(bool& data, const Glib::ustring &name)
 {
-    //the data tags are stored with leading "d_", so prepend it here
-    name = "d_" + name;
-
-    std::map<Glib::ustring, Glib::ustring>::const_iterator it;
-    it = d_data.find(name);
+    const Glib::ustring *it = findData(name);
 
-    if (it == d_data.end())
+    if (it == NULL)
     {
-        std::cerr<<String::ucompose(_("Error!  couldn't get bool value from xml tag `%1'."), name) << std::endl;
+        std::cerr<<String::ucompose(_("Error!  couldn't get bool value from xml tag `%1'."), "d_" + name) << std::endl;
         d_failed = true;
         return false;
     }
     
-    if ((*it).second == "true")
+    if (it->raw() == "true")
     {
         data = true;
         return true;
     }
 
-    if ((*it).second == "false")
+    if (it->raw() == "false")
     {
         data = false;
         return true;
@@ -506,96 +781,159 @@ bool XML_Helper::getData(bool& data, Glib::ustring name)
     return false;
 }
 
-bool XML_Helper::getData(int& data, Glib::ustring name)
+bool XML_Helper::getData(int& data, const Glib::ustring &name)
 {
-    //the data tags are stored with leading "d_", so prepend it here
-    name = "d_" + name;
-
-    std::map<Glib::ustring, Glib::ustring>::const_iterator it;
-    it = d_data.find(name);
+    const Glib::ustring *it = findData(name);
 
-    if (it == d_data.end())
+    if (it == NULL)
     {
-        std::cerr<<String::ucompose(_("Error!  couldn't get int value from xml tag `%1'."), name) << std::endl;
+        std::cerr<<String::ucompose(_("Error!  couldn't get int value from xml tag `%1'."), "d_" + name) << std::endl;
         d_failed = true;
         return false;
     }
     
-    data = atoi((*it).second.c_str());
+    data = atoi(it->c_str());
     return true;
 }
 
-bool XML_Helper::getData(guint32& data, Glib::ustring name)
+bool XML_Helper::getData(guint32& data, const Glib::ustring &name)
 {
-    //the data tags are stored with leading "d_", so prepend it here
-    name = "d_" + name;
-
-    std::map<Glib::ustring, Glib::ustring>::const_iterator it;
-    it = d_data.find(name);
+    const Glib::ustring *it = findData(name);
 
-    if (it == d_data.end())
+    if (it == NULL)
     {
-        std::cerr<<String::ucompose(_("Error!  couldn't get guint32 value from xml tag `%1'."), name) << std::endl;
+        std::cerr<<String::ucompose(_("Error!  couldn't get guint32 value from xml tag `%1'."), "d_" + name) << std::endl;
         d_failed = true;
         return false;
     }
     
-    data = static_cast<guint32>(atoi((*it).second.c_str()));
+    data = static_cast<guint32>(atoi(it->c_str()));
     return true;
 
     
 }
 
-bool XML_Helper::getData(double& data, Glib::ustring name)
+bool XML_Helper::getData(double& data, const Glib::ustring &name)
 {
-    //the data tags are stored with leading "d_", so prepend it here
-    name = "d_" + name;
+    const Glib::ustring *it = findData(name);
 
-    std::map<Glib::ustring, Glib::ustring>::const_iterator it;
-    it = d_data.find(name);
-
-    if (it == d_data.end())
+    if (it == NULL)
     {
-        std::cerr<<String::ucompose(_("Error!  couldn't get double value from xml tag `%1'."), name) << std::endl;
+        std::cerr<<String::ucompose(_("Error!  couldn't get double value from xml tag `%1'."), "d_" + name) << std::endl;
         d_failed = true;
         return false;
     }
 
-    data = strtod((*it).second.c_str(), 0);
+    data = strtod(it->c_str(), 0);
     return true;
 }
 
+const Glib::ustring *XML_Helper::findData(const Glib::ustring &name) const
+{
+  //the data tags are stored without their leading "d_"
+  for (guint32 i = 0; i < d_num_data; i++)
+    if (d_data[i].name == name.raw())
+      return &d_data[i].value;
+  return NULL;
+}
+
+void XML_Helper::setData(const char *name, const Glib::ustring &value)
+{
+  // a later tag with the same name wins, e.g. a translated name.
+  for (guint32 i = 0; i < d_num_data; i++)
+    if (d_data[i].name == name)
+      {
+        d_data[i].value = value;
+        return;
+      }
+
+  // the items are reused from one tag to the next so that their strings
+  // don't have to be allocated again.
+  if (d_num_data == d_data.size())
+    d_data.push_back(DataItem());
+  d_data[d_num_data].name = name;
+  d_data[d_num_data].value = value;
+  d_num_data++;
+}
+
+const std::string *XML_Helper::intern(const Glib::ustring &name)
+{
+  return &*d_names.insert(name.raw()).first;
+}
+
+void XML_Helper::parse_bytes(const char *data, gsize len, bool &newline_at_end_of_document)
+{
+  try
+    {
+      parse_chunk_raw((const unsigned char*)data, len);
+    }
+  catch (xmlpp::parse_error &e)
+    {
+      Glib::ustring msg = e.what();
+      if (msg.find("Extra content at the end of the document") != 
+          Glib::ustring::npos)
+        {
+          d_failed = false;
+          newline_at_end_of_document = true;
+        }
+      else
+        std::cerr << msg << std::endl;
+    }
+}
+
 bool XML_Helper::parseXML()
 {
   bool newline_at_end_of_document = false;
   if (!d_in || d_failed)
     return false;
 
-  char buffer[1024];
-    do 
-      {
-        memset (buffer, 0, sizeof (buffer));
-        d_in->read(buffer, sizeof (buffer) - 1);
-        Glib::ustring input(buffer);
-        try
-          {
-            parse_chunk(input);
-          }
-        catch (xmlpp::parse_error &e)
-          {
-            Glib::ustring msg = e.what();
-            if (msg.find("Extra content at the end of the document") != 
-                Glib::ustring::npos)
-              {
-                d_failed = false;
-                newline_at_end_of_document = true;
-              }
-            else
-              std::cerr << msg << std::endl;
-          }
-        if (d_failed)
-          break;
-      } while (*d_in);
+  // the bytes go to the parser as they are, in big pieces.  they aren't
+  // turned into strings first, so a utf-8 character can't get split.
+  GMappedFile *mapped = NULL;
+  if (d_filename.empty() == false)
+    mapped = g_mapped_file_new(d_filename.c_str(), FALSE, NULL);
+  if (mapped)
+    {
+      const char *contents = g_mapped_file_get_contents(mapped);
+      gsize len = g_mapped_file_get_length(mapped);
+      if (is_binary(contents, len))
+        {
+          parse_binary(contents, len);
+          g_mapped_file_unref(mapped);
+          return (!d_failed);
+        }
+      for (gsize pos = 0; pos < len; pos += PARSE_CHUNK_SIZE)
+        {
+          parse_bytes(contents + pos, std::min(len - pos,
+                                               (gsize)PARSE_CHUNK_SIZE),
+                      newline_at_end_of_document);
+          if (d_failed)
+            break;
+        }
+      g_mapped_file_unref(mapped);
+    }
+  else
+    {
+      std::vector<char> buffer(PARSE_CHUNK_SIZE);
+      d_in->read(&buffer[0], buffer.size());
+      gsize len = d_in->gcount();
+      if (is_binary(&buffer[0], len))
+        {
+          // the binary form is read all at once.
+          std::string document(&buffer[0], len);
+          document.append(std::istreambuf_iterator<char>(*d_in),
+                          std::istreambuf_iterator<char>());
+          return parse_binary(document.data(), document.size());
+        }
+      while (true)
+        {
+          parse_bytes(&buffer[0], len, newline_at_end_of_document);
+          if (d_failed || !(*d_in))
+            break;
+          d_in->read(&buffer[0], buffer.size());
+          len = d_in->gcount();
+        }
+    }
   
   if (!d_failed && !newline_at_end_of_document)
     finish_chunk_parsing();
@@ -603,6 +941,102 @@ bool XML_Helper::parseXML()
   return (!d_failed);
 }
 
+bool XML_Helper::parse_binary(const char *data, gsize len)
+{
+  const unsigned char *p = (const unsigned char*)data + BINARY_MAGIC_SIZE;
+  const unsigned char *end = (const unsigned char*)data + len;
+  if (*p++ > BINARY_FORMAT_VERSION)
+    {
+      std::cerr << "XML_Helper: the binary document is from a newer version\n";
+      d_failed = true;
+      return false;
+    }
+
+  // the numbers of the tag names, and the tags that are open.
+  std::vector<Glib::ustring> names;
+  std::vector<guint32> open;
+  std::string text;
+  Glib::ustring lang, value;
+  char buf[32];
+  bool damaged = false;
+  while (p < end && !d_failed && !damaged)
+    {
+      int record = *p++;
+      guint32 id = 0;
+      guint64 num = 0;
+      if (record == BINARY_CLOSE_TAG)
+        {
+          if (open.empty())
+            damaged = true;
+          else
+            {
+              tag_close(names[open.back()], "");
+              open.pop_back();
+            }
+          continue;
+        }
+      else if (record == BINARY_LANG)
+        {
+          damaged = !read_string(p, end, text);
+          lang = text;
+          continue;
+        }
+      if (!read_name(p, end, names, id))
+        {
+          damaged = true;
+          break;
+        }
+      switch (record)
+        {
+        case BINARY_OPEN_TAG:
+          if (open.empty())
+            {
+              damaged = !read_string(p, end, text);
+              tag_open(names[id], text, "");
+            }
+          else
+            tag_open(names[id], "", "");
+          open.push_back(id);
+          continue;
+        case BINARY_STRING:
+          damaged = !read_string(p, end, text);
+          value = text;
+          break;
+        case BINARY_INT:
+          damaged = !read_varint(p, end, num);
+          g_snprintf(buf, sizeof(buf), "%" G_GINT64_FORMAT, unzigzag(num));
+          value = buf;
+          break;
+        case BINARY_UINT:
+          damaged = !read_varint(p, end, num);
+          g_snprintf(buf, sizeof(buf), "%" G_GUINT64_FORMAT, num);
+          value = buf;
+          break;
+        case BINARY_TRUE:
+          value = "true";
+          break;
+        case BINARY_FALSE:
+          value = "false";
+          break;
+        default:
+          damaged = true;
+          break;
+        }
+      if (damaged)
+        break;
+      // a data tag opens and closes in one go
+      tag_open(names[id], "", lang);
+      tag_close(names[id], value);
+      lang.clear();
+    }
+  if ((damaged || !open.empty()) && !d_failed)
+    {
+      std::cerr << "XML_Helper: the binary document is damaged\n";
+      d_failed = true;
+    }
+  return (!d_failed);
+}
+
 //beginning with here is only internal stuff. Continue reading only if you are
 //interested in the xml parsing. :)
 
@@ -629,51 +1063,60 @@ bool XML_Helper::parseXML()
  * which has led tag_open to already call the callback.
  */
 
-bool XML_Helper::tag_open(Glib::ustring tag, Glib::ustring version, Glib::ustring lang)
+bool XML_Helper::tag_open(const Glib::ustring &name, const Glib::ustring &version, const Glib::ustring &lang)
 {
     if (d_failed)
         return false;
         
     //first of all, register the tag as opened
-    d_tags.push_front(tag);
+    const std::string *tag = intern(name);
+    d_tags.push_back(tag);
 
-    if (version != "")
+    if (version.empty() == false)
         d_version = version;
 
     //look if the tag starts with "d_". If so, it is a data tag without anything
     //important in between
-    if ((tag[0] == 'd') && (tag[1] == '_'))
+    if (((*tag)[0] == 'd') && ((*tag)[1] == '_'))
       {
-	d_lang[tag] = lang;
+	d_data_lang = lang;
 	return true;
       }
+
+    //when converting, the tag just gets written out again
+    if (d_copy_to)
+      {
+        if (d_tags.size() == 1)
+          d_copy_to->begin(d_version);
+        return d_copy_to->openTag(name);
+      }
     
     //first of all, look if another important tag has already been opened
     //and call the appropriate callback if so
-    std::list<Glib::ustring>::iterator ls_it = d_tags.begin();
-    ++ls_it;
+    const std::string *parent = NULL;
+    if (d_tags.size() > 1)
+      parent = d_tags[d_tags.size() - 2];
 
-    if ((ls_it != d_tags.end()) && (d_last_opened == (*ls_it)))
+    if (parent && d_last_opened == parent)
     {
-        std::map<Glib::ustring, XML_Slot>::iterator it;
-        it = d_callbacks.find(*ls_it);
+        std::map<std::string, XML_Slot>::iterator it;
+        it = d_callbacks.find(*parent);
 
         
         if (it != d_callbacks.end())
         {
             //make the callback (yes that is the syntax, overloaded "()")
-            bool retval = (it->second)(*ls_it, this);
+            bool retval = (it->second)(*parent, this);
             if (retval == false)
             {
-                std::cerr << String::ucompose(_("%1: Callback for xml tag returned false.  Stop parsing document."), (*ls_it)) << std::endl;
+                std::cerr << String::ucompose(_("%1: Callback for xml tag returned false.  Stop parsing document."), *parent) << std::endl;
                 error = true;
                 d_failed = true;
             }
         }
 
         //clear d_data (we are just setting up a new tag)
-        d_data.clear();
-        d_lang.clear();
+        d_num_data = 0;
     }
 
     d_last_opened = tag;
@@ -681,18 +1124,18 @@ bool XML_Helper::tag_open(Glib::ustring tag, Glib::ustring version, Glib::ustrin
     return true;
 }
 
-bool XML_Helper::lang_check(Glib::ustring lang)
+bool XML_Helper::lang_check(const Glib::ustring &lang)
 {
   static char *envlang = getenv("LANG");
   if (envlang == NULL)
     envlang = getenv("LC_ALL");
   if (envlang == NULL)
     envlang = getenv("LC_CTYPE");
-  if (lang == "")
+  if (lang.empty())
     return true;
   if (envlang == NULL)
     return false;
-  if (lang == envlang)
+  if (lang.raw() == envlang)
     return true;
   //try harder
   char *first_underscore = strchr (envlang, '_');
@@ -704,36 +1147,43 @@ bool XML_Helper::lang_check(Glib::ustring lang)
   return false;
 }
 
-bool XML_Helper::tag_close(Glib::ustring tag, Glib::ustring cdata)
+bool XML_Helper::tag_close(const Glib::ustring &name, const Glib::ustring &cdata)
 {
     if (d_failed)
         return false;
 
     //remove tag entry, there is nothing more to be done
-    d_tags.pop_front();
+    const std::string *tag = d_tags.back();
+    d_tags.pop_back();
     
-    if ((tag[0] == 'd') && (tag[1] == '_'))
+    if (((*tag)[0] == 'd') && ((*tag)[1] == '_'))
     {
+        if (d_copy_to)
+          return d_copy_to->copyData(tag->c_str() + 2, cdata, d_data_lang);
+
         // save the data (we close a data tag)
-	if (lang_check(d_lang[tag]))
-	  d_data[tag] = cdata;
+	if (lang_check(d_data_lang))
+	  setData(tag->c_str() + 2, cdata);
         return true;    //data tags end here with their execution
     }
 
+    if (d_copy_to)
+      return d_copy_to->closeTag();
+
     if ((d_last_opened == tag))
     //callback hasn't been called yet
     {
-        std::map<Glib::ustring, XML_Slot>::iterator it;
-        it = d_callbacks.find(tag);
+        std::map<std::string, XML_Slot>::iterator it;
+        it = d_callbacks.find(*tag);
         
         if (it != d_callbacks.end())
         {
             //make the callback (yes that is the syntax, overloaded "()")
-            bool retval = it->second(tag, this);
+            bool retval = it->second(name, this);
             
             if (retval == false)
             {
-                std::cerr << String::ucompose(_("%1: Callback for xml tag returned false.  Stop parsing document."), tag) << std::endl;
+                std::cerr << String::ucompose(_("%1: Callback for xml tag returned false.  Stop parsing document."), name) << std::endl;
                 error = true;
                 d_failed = true;
             }
@@ -741,8 +1191,7 @@ bool XML_Helper::tag_close(Glib::ustring tag, Glib::ustring cdata)
     }
 
     //clear d_data (we are just setting up a new tag)
-    d_data.clear();
-    d_lang.clear();
+    d_num_data = 0;
     
     return true;
 }
@@ -750,6 +1199,19 @@ bool XML_Helper::tag_close(Glib::ustring tag, Glib::ustring cdata)
 Glib::ustring XML_Helper::get_top_tag(Glib::ustring filename)
 {
   char buffer[1024];
+  if (isBinaryFile(filename))
+    {
+      // the first record opens the top tag, and has the first name
+      std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+      in.read(buffer, sizeof buffer);
+      const unsigned char *p = (const unsigned char*)buffer + BINARY_MAGIC_SIZE + 1;
+      const unsigned char *end = (const unsigned char*)buffer + in.gcount();
+      std::vector<Glib::ustring> names;
+      guint32 id = 0;
+      if (p < end && *p++ == BINARY_OPEN_TAG && read_name(p, end, names, id))
+        return names[id];
+      return "";
+    }
   XML_Helper in(filename, std::ios::in);
   while (in.d_in->eof() == false)
     {
@@ -772,6 +1234,10 @@ Glib::ustring XML_Helper::get_top_tag(Glib::ustring filename)
 
 bool XML_Helper::rewrite_version(Glib::ustring filename, Glib::ustring tag, Glib::ustring new_version)
 {
+  // the version gets rewritten in the xml form.
+  if (isBinaryFile(filename) && convertFile(filename, false) == false)
+    return false;
+
   Glib::ustring match = "<" + tag + " version=\"";
   bool found = false;
   char buffer[1024];
@@ -787,7 +1253,7 @@ bool XML_Helper::rewrite_version(Glib::ustring filename, Glib::ustring tag, Glib
           found = true;
           Glib::ustring upgraded_line = match + new_version + "\">";
           out.d_out->write(upgraded_line.c_str(), upgraded_line.length());
-          (*out.d_out) << std::endl;
+          (*out.d_out) << "\n";
         }
       else
         {
@@ -807,7 +1273,7 @@ bool XML_Helper::rewrite_version(Glib::ustring filename, Glib::ustring tag, Glib
                 len--;
               out.d_out->write(buffer, len);
             }
-          (*out.d_out) << std::endl;
+          (*out.d_out) << "\n";
         }
     }
   out.close();
@@ -823,15 +1289,15 @@ void XML_Helper::on_start_element(const Glib::ustring& name, const AttributeList
   //the only attribute we know and handle are version and lang strings
   for(xmlpp::SaxParser::AttributeList::const_iterator i = a.begin(); i != a.end(); ++i)
     {
-      if ((*i).name == "version")
+      if ((*i).name.raw() == "version")
         version = (*i).value;
-      else if((*i).name == "xml:lang")
+      else if((*i).name.raw() == "xml:lang")
         lang = (*i).value;
     }
 
   my_cdata = "";
 
-  error = !tag_open(Glib::ustring(name), version, lang);
+  error = !tag_open(name, version, lang);
 
 }
       
@@ -840,7 +1306,7 @@ void XML_Helper::on_end_element(const Glib::ustring& name)
   if (error)
     return;
 
-  error = !tag_close(Glib::ustring(name), my_cdata);
+  error = !tag_close(name, my_cdata);
 
   my_cdata = "";
 
@@ -886,6 +1352,14 @@ bool XML_Helper::saveData(Glib::ustring name, const Gdk::RGBA value)
         return false;
     }
 
+    if (d_binary)
+      {
+        d_out->put(BINARY_STRING);
+        put_name(name.raw());
+        put_string(rgb_to_string(value).raw());
+        return true;
+      }
+
     addTabs();
     char buf[3];
     guint32 r, g, b;
@@ -902,24 +1376,19 @@ bool XML_Helper::saveData(Glib::ustring name, const Gdk::RGBA value)
     (*d_out) <<"<" <<name <<">#" <<red <<green<<blue <<"</" <<name <<">\n";
   return true;
 }
-bool XML_Helper::getData(Gdk::RGBA & data, Glib::ustring name)
+bool XML_Helper::getData(Gdk::RGBA & data, const Glib::ustring &name)
 {
-    //the data tags are stored with leading "d_", so prepend it here
-    name = "d_" + name;
-
-    std::map<Glib::ustring, Glib::ustring>::const_iterator it;
+    const Glib::ustring *it = findData(name);
 
-    it = d_data.find(name);
-    
-    if (it == d_data.end())
+    if (it == NULL)
     {
         data.set_rgba(0,0,0);
-        std::cerr<<String::ucompose(_("Error!  couldn't get Gdk::RGBA value from xml tag `%1'."), name) << std::endl;
+        std::cerr<<String::ucompose(_("Error!  couldn't get Gdk::RGBA value from xml tag `%1'."), "d_" + name) << std::endl;
         d_failed = true;
         return false;
     }
     
-    Glib::ustring value = (*it).second;
+    Glib::ustring value = *it;
     char buf[15];
     int retval = sscanf(value.c_str(), "%s", buf);
     if (retval == -1)
@@ -66,6 +66,14 @@
   *
   * If this explanation was confusing, have a look at the loading and saving
   * functions. They should make the point somewhat clearer.
+  *
+  * Binary files:
+  * The same tags and data can also be written in a compact binary form by
+  * opening the file with std::ios::binary.  Numbers and booleans are kept
+  * as numbers, and every tag name is only spelled out the first time it is
+  * used.  Reading works the same way for both forms; the form of a file is
+  * recognized by the first few bytes.  Use convertFile() to turn one form
+  * into the other.
   */
 
 #pragma once
@@ -78,6 +86,8 @@
 #include <fstream>
 #include <list>
 #include <map>
+#include <vector>
+#include <unordered_set>
 #include <sigc++/slot.h>
 #include <libxml++/libxml++.h>
     
@@ -95,7 +105,9 @@ class XML_Helper: public xmlpp::SaxParser
         /** The most common constructor reads or writes to a file
           * 
           * @param filename     the filename where data read from/written to
-          * @param openmode     either std::ios::in for reading or out for writing
+          * @param openmode     either std::ios::in for reading or out for
+          *                     writing.  Add std::ios::binary when writing
+          *                     to write the compact binary form.
           */ 
         XML_Helper(Glib::ustring filename, std::ios::openmode mode);
 
@@ -108,8 +120,9 @@ class XML_Helper: public xmlpp::SaxParser
         /** This constructor writes to a given output stream.
           * 
           * @param output       the output stream to write to
+          * @param binary       whether to write the compact binary form
           */
-        XML_Helper(std::ostream* output);
+        XML_Helper(std::ostream* output, bool binary = false);
         ~XML_Helper();
 
         /** Call this at the very beginning of the saving procedure. It
@@ -151,6 +164,7 @@ class XML_Helper: public xmlpp::SaxParser
 	bool saveData(Glib::ustring identifier, const Gdk::RGBA value);
 
         /** Closes the reading/writing stream.
+          * @return false if the file couldn't be completely written.
           * @note As soon as you call this function, the object is dead with
           * all streams cut. It is just here to force saving of files as the
           * streams are also closed in the destructor.
@@ -181,13 +195,13 @@ class XML_Helper: public xmlpp::SaxParser
           * @note For string data you can also specify if the data should be
           * translated ro not.
           */
-        bool getData(Glib::ustring& data, Glib::ustring name);
-        bool getData(bool& data, Glib::ustring name);
-        bool getData(int& data, Glib::ustring name);
-        bool getData(guint32& data, Glib::ustring name);
-        bool getData(double& data, Glib::ustring name);
-	bool getData(std::vector<Gdk::RGBA> & data, Glib::ustring name);
-	bool getData(Gdk::RGBA & data, Glib::ustring name);
+        bool getData(Glib::ustring& data, const Glib::ustring &name);
+        bool getData(bool& data, const Glib::ustring &name);
+        bool getData(int& data, const Glib::ustring &name);
+        bool getData(guint32& data, const Glib::ustring &name);
+        bool getData(double& data, const Glib::ustring &name);
+	bool getData(std::vector<Gdk::RGBA> & data, const Glib::ustring &name);
+	bool getData(Gdk::RGBA & data, const Glib::ustring &name);
 
         //! Returns the version number of the save file
         Glib::ustring getVersion() const {return d_version;}
@@ -197,6 +211,20 @@ class XML_Helper: public xmlpp::SaxParser
 
         static Glib::ustring get_top_tag(Glib::ustring filename);
         static bool rewrite_version(Glib::ustring filename, Glib::ustring tag, Glib::ustring new_version);
+
+        //! Returns whether or not the given file is in the binary form.
+        static bool isBinaryFile(Glib::ustring filename);
+
+        /** Rewrites a file in the binary form, or as xml.
+          *
+          * Nothing is lost either way: turning a file into the other form
+          * and back again gives the same file.
+          *
+          * @param filename     the file to rewrite
+          * @param binary       true for the binary form, false for xml
+          * @return false if the file couldn't be read or written
+          */
+        static bool convertFile(Glib::ustring filename, bool binary);
         static guint32 flagsFromString(Glib::ustring flags, guint32 (*flagStrToNum)(Glib::ustring));
         
 
@@ -211,33 +239,90 @@ class XML_Helper: public xmlpp::SaxParser
           */
         inline void addTabs();
 
-	bool lang_check(Glib::ustring lang);
+	bool lang_check(const Glib::ustring &lang);
+
+        bool tag_open(const Glib::ustring &name, const Glib::ustring &version, const Glib::ustring &lang);
+
+        bool tag_close(const Glib::ustring &name, const Glib::ustring &cdata);
+
+        //! Hands some of the document over to the parser.
+        void parse_bytes(const char *data, gsize len, bool &newline_at_end_of_document);
+
+        //! Reads a whole document in the binary form.
+        bool parse_binary(const char *data, gsize len);
+
+        //! Writes a number in as few bytes as it takes.
+        void put_varint(guint64 value);
+
+        //! Writes a length and then the bytes of a string.
+        void put_string(const std::string &value);
 
-        bool tag_open(Glib::ustring tag, Glib::ustring version, Glib::ustring lang);
+        //! Writes the number of a tag name, and the name itself if it is new.
+        void put_name(const std::string &name);
 
-        bool tag_close(Glib::ustring tag, Glib::ustring cdata = "");
+        //! Writes a data tag in either form, when copying a document.
+        bool copyData(const Glib::ustring &name, const Glib::ustring &value, const Glib::ustring &lang);
+
+        //! Returns the data with the given name (without "d_"), or NULL.
+        const Glib::ustring *findData(const Glib::ustring &name) const;
+
+        //! Keeps the data of a data tag, named without its "d_".
+        void setData(const char *name, const Glib::ustring &value);
+
+        /** Returns the one copy of the given tag name, so that tag names
+          * can be kept and compared as pointers.
+          */
+        const std::string *intern(const Glib::ustring &name);
 
         //streams, d_fout and d_fin are used when it comes to file
         //handling, d_in and d_out are used when actually reading or
         //writing data(either point to d_fout or d_fin or have a
         //separate stream)
         std::istringstream* d_inbuf;
-        std::ostringstream* d_outbuf;
 
         std::ofstream* d_fout;    
+        //! The fixed-size buffer that d_fout writes through.
+        std::vector<char> d_fout_buffer;
         std::ifstream* d_fin;
         std::ostream* d_out;
         std::istream* d_in;
 
-        std::list<Glib::ustring> d_tags;
+        //! The file being read, so that it can be mapped into memory.
+        Glib::ustring d_filename;
+
+        //! The names of the tags that are open, the innermost one last.
+        std::vector<const std::string*> d_tags;
+
+        //! Every tag name that has been seen, see intern().
+        std::unordered_set<std::string> d_names;
 
-        std::map<Glib::ustring, XML_Slot> d_callbacks;
-        std::map<Glib::ustring, Glib::ustring> d_data;
-        std::map<Glib::ustring, Glib::ustring> d_lang;
+        std::map<std::string, XML_Slot> d_callbacks;
+
+        //! A data tag that belongs to the tag being loaded.
+        struct DataItem
+        {
+          std::string name;
+          Glib::ustring value;
+        };
+        //! The data of the tag being loaded; only the first d_num_data count.
+        std::vector<DataItem> d_data;
+        guint32 d_num_data;
+
+        //! The language of the data tag that is open.
+        Glib::ustring d_data_lang;
         
-        Glib::ustring d_last_opened;
+        const std::string *d_last_opened;
         Glib::ustring d_version;
 
+        //! Whether the compact binary form is being written.
+        bool d_binary;
+
+        //! The numbers given to tag names so far when writing the binary form.
+        std::map<std::string, guint32> d_binary_names;
+
+        //! When converting, the tags that are read get written here instead.
+        XML_Helper *d_copy_to;
+
         bool d_failed;
         Glib::ustring my_cdata;
         bool error;